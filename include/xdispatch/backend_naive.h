@@ -44,11 +44,15 @@ namespace naive {
                   will be executed
     @param priority Choose a priority different from default to automatically
                   have the priority of the thread reconfigured
+    @param resource The memory_resource to allocate the queue and all
+                  memory used on its behalf from, defaults to the
+                  resource of the thread
     */
 XDISPATCH_EXPORT queue
 create_serial_queue(const std::string& label,
                     const ithreadpool_ptr& thread,
-                    queue_priority priority = queue_priority::DEFAULT);
+                    queue_priority priority = queue_priority::DEFAULT,
+                    memory_resource* resource = nullptr);
 
 /**
     @return A new parallel queue powered by the given pool
@@ -57,11 +61,59 @@ create_serial_queue(const std::string& label,
     @param pool The threadpool on which queued operations will be executed
     @param priority Controls the priority assigned to draining the queue
                 relative from other runnables added to the pool
+    @param resource The memory_resource to allocate the queue and all
+                memory used on its behalf from, defaults to the resource
+                of the pool
     */
 XDISPATCH_EXPORT queue
 create_parallel_queue(const std::string& label,
                       const ithreadpool_ptr& pool,
-                      queue_priority priority = queue_priority::DEFAULT);
+                      queue_priority priority = queue_priority::DEFAULT,
+                      memory_resource* resource = nullptr);
+
+/**
+    @return A new parallel queue executing at most max_width operations
+            at the same time, powered by the global pool of the backend
+
+    Operations exceeding the width are buffered by the queue itself and
+    picked up as soon as a running operation completes. No thread will
+    block while waiting for a free slot.
+
+    @param label The name to use for the new queue
+    @param max_width The maximum number of operations to execute
+                concurrently, needs to be at least 1
+    @param priority Controls the priority assigned to draining the queue
+                relative from other runnables added to the pool
+    @param resource The memory_resource to allocate the queue and all
+                memory used on its behalf from, defaults to
+                get_default_resource()
+    */
+XDISPATCH_EXPORT queue
+create_concurrent_queue(const std::string& label,
+                        size_t max_width,
+                        queue_priority priority = queue_priority::DEFAULT,
+                        memory_resource* resource = nullptr);
+
+/**
+    @return A new parallel queue executing at most max_width operations
+            at the same time, powered by the given pool
+
+    @param label The name to use for the new queue
+    @param max_width The maximum number of operations to execute
+                concurrently, needs to be at least 1
+    @param pool The threadpool on which queued operations will be executed
+    @param priority Controls the priority assigned to draining the queue
+                relative from other runnables added to the pool
+    @param resource The memory_resource to allocate the queue and all
+                memory used on its behalf from, defaults to the resource
+                of the pool
+    */
+XDISPATCH_EXPORT queue
+create_concurrent_queue(const std::string& label,
+                        size_t max_width,
+                        const ithreadpool_ptr& pool,
+                        queue_priority priority = queue_priority::DEFAULT,
+                        memory_resource* resource = nullptr);
 
 } // namespace naive
 __XDISPATCH_END_NAMESPACE
@@ -66,6 +66,21 @@ public:
      */
     static ithreadpool* current();
 
+    /**
+        @brief Executes a single operation pending on the threadpool
+       executing the calling thread, if any
+
+        Use this to make progress while waiting on a thread of the pool
+        instead of blocking it. Operations executed this way may wait and
+        help themselves, the nesting is limited to a fixed depth though.
+        No operation is executed while a serial queue is executing an
+        operation on the calling thread, as the helped operation would
+        otherwise run within the serial queue's operation.
+
+        @returns true if an operation was executed
+     */
+    static bool help_current();
+
     /**
         @brief Helper to mark a thread as blocked, i.e. not running anymore.
 
@@ -107,6 +122,30 @@ protected:
         @brief Runs the given operation in the scope of the given threadpool
     */
     static void run_with_threadpool(operation&, ithreadpool*);
+
+    // virtual functions added later on are declared last to retain the
+    // layout of the vtable and are not pure so that existing pools
+    // compile and behave unchanged
+
+public:
+    /**
+        @returns The memory_resource queues driven by this pool allocate
+                 from unless given a resource of their own
+
+        The default implementation returns get_default_resource().
+     */
+    virtual memory_resource* resource() { return get_default_resource(); }
+
+protected:
+    /**
+        @brief Executes a single pending operation on the calling thread
+
+        Invoked by help_current() on threads of this pool only.
+
+        @returns false if no operation was pending. The default
+                 implementation never executes any operation.
+     */
+    virtual bool try_execute_pending() { return false; }
 };
 
 inline ithreadpool::block_scope::block_scope()
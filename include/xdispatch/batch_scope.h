@@ -0,0 +1,117 @@
+/*
+ * batch_scope.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef XDISPATCH_BATCH_SCOPE_H_
+#define XDISPATCH_BATCH_SCOPE_H_
+
+/**
+ * @addtogroup xdispatch
+ * @{
+ */
+
+#include <vector>
+
+#include "xdispatch/dispatch.h"
+
+__XDISPATCH_BEGIN_NAMESPACE
+
+/**
+    Buffers all operations passed to queue::async() on the current thread
+    while the scope is alive and passes them to their queues in bulk.
+
+    Submitting many operations one by one pays for locking the queue and
+    waking a thread on every call. Within a batch_scope the operations are
+    collected per target queue instead and handed over as a single bulk
+    enqueue followed by a single wakeup once the scope ends or the number
+    of operations buffered for a queue reached the threshold.
+
+    Existing code will make use of the batching without further changes:
+
+    @code
+    {
+        xdispatch::batch_scope batch;
+        for (auto& item : items) {
+            q.async([&item] { process(item); });
+        }
+    } // all operations are handed to q here
+    @endcode
+
+    Operations buffered for a queue are flushed before any other
+    submission to the same queue (e.g. sync() or barrier_async()) made
+    on the thread so that the order of submissions is retained. Note that
+    buffered operations will not start executing before being flushed, so
+    never wait for them to complete from within the scope. Operations
+    executed on the thread while it is blocked, e.g. by sync(), submit
+    directly and may wait for their submissions.
+
+    Nested scopes join the outermost scope active on the thread.
+*/
+class XDISPATCH_EXPORT batch_scope
+{
+public:
+    /**
+        @brief The default number of operations buffered per queue
+     */
+    static constexpr size_t default_threshold = 64;
+
+    /**
+        @brief Starts batching submissions made on the calling thread
+
+        @param threshold The number of operations buffered for a single
+                         queue before they are flushed
+     */
+    explicit batch_scope(size_t threshold = default_threshold);
+
+    /**
+        @brief Flushes all buffered operations and ends batching
+     */
+    ~batch_scope();
+
+    /**
+        @brief Passes all operations buffered so far to their queues
+     */
+    void flush();
+
+private:
+    batch_scope(const batch_scope&) = delete;
+    batch_scope& operator=(const batch_scope&) = delete;
+
+    friend class batch_scope_access;
+
+    struct batch
+    {
+        iqueue_impl_ptr m_queue;
+        std::vector<inline_operation> m_ops;
+    };
+
+    const size_t m_threshold;
+    const bool m_outermost;
+    std::vector<batch> m_batches;
+
+    void flush(batch&);
+};
+
+__XDISPATCH_END_NAMESPACE
+
+/** @} */
+
+#endif /* XDISPATCH_BATCH_SCOPE_H_ */
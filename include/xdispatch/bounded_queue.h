@@ -0,0 +1,164 @@
+/*
+ * bounded_queue.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XDISPATCH_BOUNDED_QUEUE_H_
+#define XDISPATCH_BOUNDED_QUEUE_H_
+
+/**
+ * @addtogroup xdispatch
+ * @{
+ */
+
+#include "xdispatch/dispatch.h"
+
+__XDISPATCH_BEGIN_NAMESPACE
+
+/**
+    @brief Defines what happens when an operation is queued to a full
+           bounded_queue
+ */
+enum class overflow_policy
+{
+    /**
+        Block the producer until an operation was started.
+
+        Producers executed by the inner queue cannot wait for it to make
+        room, their operations are discarded and counted as dropped instead.
+        This is detected only on backends supporting queue::is_current(),
+        on all others such a producer deadlocks.
+    */
+    block,
+    //! Do not queue the new operation, try_async() returns false
+    reject,
+    //! Discard the operation waiting the longest to make room
+    drop_oldest,
+    //! Discard the operation queued last to make room
+    drop_newest
+};
+
+/**
+    Provides a wrapper around any queue limiting the number of operations
+    waiting for execution.
+
+    Operations are buffered by the bounded_queue itself and passed on to
+    the inner queue one by one. Once capacity operations are waiting
+    for execution, the configured overflow_policy is applied to
+    further operations. Operations which have already started executing
+    do not count towards the capacity.
+
+    Handlers may be installed to be notified once the number of waiting
+    operations reaches a high watermark and when it drops to a low
+    watermark again, e.g. to propagate backpressure to a producer.
+    Handlers are executed on the thread changing the depth of the queue.
+
+    @remark Operations queued via sync(), apply() or barrier_async() are
+    passed to the inner queue directly and are not subject to the capacity.
+*/
+class XDISPATCH_EXPORT bounded_queue : public queue
+{
+public:
+    /**
+        @brief Creates a new bounded queue using a private serial queue for
+               delegation
+
+        The queue will be created using the platform default backend
+
+        @param label The name to be given to the private queue
+        @param capacity The maximum number of operations waiting for
+                        execution, needs to be at least 1
+        @param policy The policy to apply once the capacity is reached
+        @param priority The priority to assign to the new queue
+     */
+    bounded_queue(const std::string& label,
+                  size_t capacity,
+                  overflow_policy policy = overflow_policy::block,
+                  queue_priority priority = queue_priority::DEFAULT);
+
+    /**
+        @brief Creates a new bounded_queue delegating to the provided queue
+
+        @param label The label to assign to this queue
+        @param inner_queue The queue to be used for async execution, this
+                           may be a serial, parallel or waitable queue
+        @param capacity The maximum number of operations waiting for
+                        execution, needs to be at least 1
+        @param policy The policy to apply once the capacity is reached
+     */
+    bounded_queue(const std::string& label,
+                  const queue& inner_queue,
+                  size_t capacity,
+                  overflow_policy policy = overflow_policy::block);
+
+    /**
+        @returns The number of operations currently waiting for execution
+     */
+    size_t depth() const;
+
+    /**
+        @returns The number of operations discarded so far due to the
+                 overflow_policy
+     */
+    size_t dropped() const;
+
+    /**
+        @brief Sets the handler to execute once the depth reaches the
+               given watermark
+
+        The handler will only be executed again after the depth dropped
+        to the low watermark in between.
+     */
+    void on_high_watermark(size_t high, const operation_ptr& op);
+
+    /**
+        @see on_high_watermark(size_t, operation_ptr)
+     */
+    template<typename Func>
+    inline void on_high_watermark(size_t high, Func&& f)
+    {
+        const auto op = make_operation(std::forward<Func>(f));
+        on_high_watermark(high, op);
+    }
+
+    /**
+        @brief Sets the handler to execute once the depth drops to the
+               given watermark after the high watermark had been reached
+     */
+    void on_low_watermark(size_t low, const operation_ptr& op);
+
+    /**
+        @see on_low_watermark(size_t, operation_ptr)
+     */
+    template<typename Func>
+    inline void on_low_watermark(size_t low, Func&& f)
+    {
+        const auto op = make_operation(std::forward<Func>(f));
+        on_low_watermark(low, op);
+    }
+
+private:
+    class impl;
+};
+
+__XDISPATCH_END_NAMESPACE
+
+/** @} */
+
+#endif /* XDISPATCH_BOUNDED_QUEUE_H_ */
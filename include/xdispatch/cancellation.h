@@ -0,0 +1,146 @@
+/*
+ * cancellation.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XDISPATCH_CANCELLATION_H_
+#define XDISPATCH_CANCELLATION_H_
+
+/**
+ * @addtogroup xdispatch
+ * @{
+ */
+
+#ifndef __XDISPATCH_INDIRECT__
+    #error                                                                     \
+      "Please #include <xdispatch/dispatch.h> instead of this file directly."
+    #include "dispatch.h"
+#endif
+
+#include <atomic>
+
+__XDISPATCH_BEGIN_NAMESPACE
+
+class cancellation_source;
+
+/**
+    @private state shared by a cancellation_source and its tokens
+ */
+class XDISPATCH_EXPORT cancellation_state : public ref_counted
+{
+public:
+    cancellation_state() noexcept
+      : ref_counted()
+      , m_cancelled(false)
+    {}
+
+    std::atomic<bool> m_cancelled;
+};
+
+/**
+    Allows to test if the operations it was attached to have been
+    cancelled
+
+    Tokens are obtained from a cancellation_source and can be passed
+    along with an operation when queueing it, e.g. via
+    queue::async(const operation_ptr&, const cancellation_token&). An
+    operation whose token was cancelled before the operation started
+    executing will be skipped without being invoked. Long running
+    operations may test the token themselves to stop early.
+
+    A default constructed token is never cancelled.
+ */
+class XDISPATCH_EXPORT cancellation_token
+{
+public:
+    /**
+        @brief Creates a token which is never cancelled
+     */
+    cancellation_token() = default;
+
+    /**
+        @returns true once the source of this token was cancelled
+     */
+    bool is_cancelled() const noexcept
+    {
+        return m_state && m_state->m_cancelled.load(std::memory_order_acquire);
+    }
+
+    /**
+        @returns true if this token was obtained from a source and
+                 can be cancelled at all
+     */
+    bool can_be_cancelled() const noexcept
+    {
+        return static_cast<bool>(m_state);
+    }
+
+private:
+    friend class cancellation_source;
+
+    explicit cancellation_token(const ref_ptr<cancellation_state>& state)
+      : m_state(state)
+    {}
+
+    ref_ptr<cancellation_state> m_state;
+};
+
+/**
+    Creates cancellation_tokens and cancels all of them at once
+
+    Cancelling is a constant time operation independent of the number of
+    tokens or operations still queued. Cancelled operations remain queued
+    until they would have been executed and are released then. Copies of
+    a source refer to the same tokens.
+ */
+class XDISPATCH_EXPORT cancellation_source
+{
+public:
+    /**
+        @brief Creates a new source which was not cancelled yet
+     */
+    cancellation_source();
+
+    /**
+        @returns A token cancelled together with this source
+     */
+    cancellation_token token() const;
+
+    /**
+        @brief Cancels all tokens obtained from this source
+
+        Operations which already started executing are not interrupted.
+        Cancelling a source multiple times has no further effect.
+     */
+    void cancel() const;
+
+    /**
+        @returns true if cancel() was invoked on this source
+     */
+    bool is_cancelled() const;
+
+private:
+    ref_ptr<cancellation_state> m_state;
+};
+
+__XDISPATCH_END_NAMESPACE
+
+/** @} */
+
+#endif /* XDISPATCH_CANCELLATION_H_ */
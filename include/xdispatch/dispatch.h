@@ -33,6 +33,8 @@
 
     #define __XDISPATCH_INDIRECT__
     #include "xdispatch/operation.h"
+    #include "xdispatch/memory_resource.h"
+    #include "xdispatch/cancellation.h"
     #include "xdispatch/queue.h"
     #include "xdispatch/backend.h"
     #include "xdispatch/group.h"
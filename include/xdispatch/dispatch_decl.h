@@ -97,8 +97,11 @@ enum class queue_priority
                       //!< blocking the user from continueing
     UTILITY,   //!< Operations for ongoing operations that the user started or
                //!< gets informed about
-    BACKGROUND //!< Operations that perform utility tasks in the background
-               //!< which are free to take longer
+    BACKGROUND, //!< Operations that perform utility tasks in the background
+                //!< which are free to take longer
+    IDLE //!< Operations that should only run when there is no other work,
+         //!< e.g. cache warming. Backends without support for idle
+         //!< operations will treat these like BACKGROUND
 };
 
 __XDISPATCH_END_NAMESPACE
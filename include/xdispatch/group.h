@@ -97,6 +97,51 @@ public:
     */
     void async(const operation_ptr& op, queue_priority priority) const;
 
+    /**
+        Dispatches an operation on the given queue to be executed before the
+       given deadline
+
+        Should the operation not have started executing once the deadline
+       passed, it will be dropped and the optional on_expired operation
+       executed in its place. Dropped operations are counted by the queue,
+       see queue::expired(). A dropped operation counts as completed for
+       the group.
+
+        @param deadline The latest point in time to start executing
+    */
+    void async(const operation_ptr& op,
+               const queue& q,
+               std::chrono::steady_clock::time_point deadline,
+               const operation_ptr& on_expired = operation_ptr()) const;
+
+    /**
+        Dispatches an operation on the given queue to be skipped once the
+       given token was cancelled
+
+        A skipped operation is not invoked but counts as completed for the
+       group, i.e. cancelling the token allows waiting on the group to
+       return without executing the remaining operations.
+
+        @param token The token to test before executing the operation
+    */
+    void async(const operation_ptr& op,
+               const queue& q,
+               const cancellation_token& token) const;
+
+    /**
+        @see async(operation_ptr, queue, cancellation_token)
+
+        Will wrap the given function in an operation and put it on the queue.
+    */
+    template<typename Func>
+    inline void async(Func&& f,
+                      const queue& q,
+                      const cancellation_token& token) const
+    {
+        const auto op = make_operation(std::forward<Func>(f));
+        async(op, q, token);
+    }
+
     /**
         @see async(operation_ptr, queue)
 
@@ -105,9 +150,10 @@ public:
        was executed.
     */
     template<typename Func>
-    inline void async(const Func& f, const queue& q = global_queue()) const
+    inline void async(Func&& f, const queue& q = global_queue()) const
     {
-        async(make_operation(f), q);
+        const auto op = make_operation(std::forward<Func>(f));
+        async(op, q);
     }
 
     /**
@@ -118,9 +164,10 @@ public:
        system until the operation was executed.
     */
     template<typename Func>
-    inline void async(const Func& f, queue_priority priority) const
+    inline void async(Func&& f, queue_priority priority) const
     {
-        async(make_operation(f), priority);
+        const auto op = make_operation(std::forward<Func>(f));
+        async(op, priority);
     }
 
     /**
@@ -150,9 +197,10 @@ public:
        for additional operations.
     */
     template<typename Func>
-    inline void notify(const Func& f, const queue& q = global_queue()) const
+    inline void notify(Func&& f, const queue& q = global_queue()) const
     {
-        notify(make_operation(f), q);
+        const auto op = make_operation(std::forward<Func>(f));
+        notify(op, q);
     }
 
     /**
@@ -23,6 +23,7 @@
 #define XDISPATCH_CANCELABLE_H_
 
 #include <atomic>
+#include <thread>
 
 /**
  * @addtogroup xdispatch
@@ -93,6 +94,9 @@ protected:
 private:
     // the current state of the handler
     std::atomic<active_state> m_active;
+    // the thread running the entity while active_running, used to
+    // detect a disable() from within the entity itself
+    std::atomic<std::thread::id> m_owner;
     // barrier to ensure defined cancellation
     lightweight_barrier m_barrier;
 };
@@ -27,7 +27,10 @@
  * @{
  */
 
+#include <vector>
+
 #include "xdispatch/impl/ibackend.h"
+#include "xdispatch/impl/lightweight_barrier.h"
 
 __XDISPATCH_BEGIN_NAMESPACE
 
@@ -40,7 +43,15 @@ public:
     /**
         @brief destructor
     */
-    virtual ~iqueue_impl() = default;
+    virtual ~iqueue_impl()
+    {
+        auto* entry = m_specifics.load();
+        while (entry) {
+            auto* next = entry->m_next;
+            delete entry;
+            entry = next;
+        }
+    }
 
     /**
       Will dispatch the given operation for
@@ -54,6 +65,78 @@ public:
       */
     virtual void async(const operation_ptr& op) = 0;
 
+    /**
+      Will dispatch the given inline_operation for async execution
+      on the iqueue_impl and return immediately.
+
+      The default implementation converts the operation to an
+      operation_ptr and forwards it to async(). Implementations able
+      to store an inline_operation directly should do so to avoid
+      the allocation.
+      */
+    virtual void async_inline(inline_operation&& op) { async(op.release()); }
+
+    /**
+      Will dispatch all given operations for async execution on the
+      iqueue_impl in order and return immediately.
+
+      The default implementation forwards every operation to async().
+      Implementations are encouraged to enqueue all operations at once
+      and wake up a thread only a single time.
+      */
+    virtual void async_bulk(std::vector<inline_operation>& ops)
+    {
+        for (auto& op : ops) {
+            async_inline(std::move(op));
+        }
+    }
+
+    /**
+      Will try to dispatch the given operation for async execution
+      on the iqueue_impl and return immediately.
+
+      @returns false if the operation was not queued, e.g. because
+               a capacity limit was reached. The default implementation
+               forwards to async() and always succeeds.
+      */
+    virtual bool try_async(const operation_ptr& op)
+    {
+        async(op);
+        return true;
+    }
+
+    /**
+      Will dispatch the given operation for async execution
+      as a barrier on the iqueue_impl and return immediately.
+
+      All operations queued before the barrier will have completed
+      before the barrier executes and operations queued after the
+      barrier will only start once it completed.
+
+      The default implementation is only correct for queues executing
+      one operation at a time and simply forwards to async().
+      */
+    virtual void barrier_async(const operation_ptr& op) { async(op); }
+
+    /**
+      Will dispatch the given operation for execution on the
+      iqueue_impl and block until it completed.
+
+      The default implementation queues the operation via async()
+      and waits for its completion. Implementations are encouraged
+      to execute the operation on the calling thread whenever the
+      queue's semantics allow it.
+      */
+    virtual void sync(const operation_ptr& op)
+    {
+        lightweight_barrier barrier;
+        async(make_operation([&barrier, op] {
+            execute_operation_on_this_thread(*op);
+            barrier.complete();
+        }));
+        barrier.wait();
+    }
+
     /**
         Applies the given iteration_operation for execution
         in this iqueue_impl and blocks until times executions
@@ -78,11 +161,118 @@ public:
      */
     virtual backend_type backend() = 0;
 
+    /**
+        @returns the priority operations queued on this iqueue_impl
+                 are executed with
+
+        Timers, socket notifiers and group notifications targeting this
+        iqueue_impl use it to schedule their helpers accordingly.
+     */
+    virtual queue_priority priority() { return queue_priority::DEFAULT; }
+
+    /**
+        Raises the priority of the operations pending on this iqueue_impl
+        to at least the given priority.
+
+        Invoked before waiting on operations of this iqueue_impl to
+        prevent a priority inversion. The default implementation does
+        nothing.
+     */
+    virtual void boost(queue_priority /* priority */) {}
+
+    /**
+        @returns the memory_resource to allocate memory used on behalf
+                 of this iqueue_impl from, e.g. operations created to
+                 track the queue's operations in a group
+
+        The default implementation returns get_default_resource().
+     */
+    virtual memory_resource* resource() { return get_default_resource(); }
+
+    /**
+        @returns the number of operations dropped so far because their
+                 deadline passed before they could be executed
+     */
+    size_t expired() const { return m_expired.load(); }
+
+    /**
+        @brief Counts an operation dropped because its deadline passed
+     */
+    void count_expired() { m_expired.fetch_add(1); }
+
+    /**
+        @brief Associates the given value with the key on this queue
+
+        Every key is stored once, setting it again replaces the value in
+        place and nullptr clears it. Only the first association of a key
+        allocates, so lookups walk the distinct keys ever set.
+     */
+    void set_specific(const void* key, void* value)
+    {
+        specific* added = nullptr;
+        auto* head = m_specifics.load();
+        while (true) {
+            if (auto* const entry = find_specific(head, key)) {
+                entry->m_value.store(value);
+                delete added;
+                return;
+            }
+            if (!value) {
+                return;
+            }
+            if (!added) {
+                added = new specific(key, value);
+            }
+            // search the entries added concurrently if this fails
+            added->m_next = head;
+            if (m_specifics.compare_exchange_weak(head, added)) {
+                return;
+            }
+        }
+    }
+
+    /**
+        @returns the value last associated with the given key or nullptr
+     */
+    void* get_specific(const void* key) const
+    {
+        const auto* const entry = find_specific(m_specifics.load(), key);
+        return entry ? entry->m_value.load() : nullptr;
+    }
+
 protected:
     iqueue_impl() = default;
 
 private:
     iqueue_impl(const iqueue_impl&) = delete;
+
+    // only the value changes once published so that lookups need no
+    // locking, entries are freed with the queue
+    struct specific
+    {
+        specific(const void* key, void* value)
+          : m_key(key)
+          , m_value(value)
+          , m_next(nullptr)
+        {}
+
+        const void* const m_key;
+        std::atomic<void*> m_value;
+        specific* m_next;
+    };
+
+    static specific* find_specific(specific* entry, const void* key)
+    {
+        for (; entry; entry = entry->m_next) {
+            if (entry->m_key == key) {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+    std::atomic<size_t> m_expired{ 0 };
+    std::atomic<specific*> m_specifics{ nullptr };
 };
 
 __XDISPATCH_END_NAMESPACE
@@ -23,6 +23,7 @@
 #define XDISPATCH_LIGHWEIGHT_BARRIER_H_
 
 #include <atomic>
+#include <cstdint>
 
 /**
  * @addtogroup xdispatch
@@ -33,13 +34,18 @@
 
 __XDISPATCH_BEGIN_NAMESPACE
 
+/**
+    @brief A barrier to be completed once and waited on by any number of
+           threads
+
+    Waiting spins briefly and parks the thread afterwards, directly on
+    the state of the barrier (i.e. using a futex) where supported. Neither
+    waiting nor completing allocates any memory.
+ */
 class XDISPATCH_EXPORT lightweight_barrier
 {
 public:
-    class waiter;
-
     lightweight_barrier();
-    ~lightweight_barrier();
 
     /**
         @brief Will wait for the operation to be executed
@@ -69,7 +75,10 @@ public:
     bool was_completed() const;
 
 private:
-    std::atomic<waiter*> m_owner;
+    // 32bit wide so that it can be waited on directly
+    std::atomic<std::uint32_t> m_state;
+
+    bool park(std::chrono::milliseconds timeout);
 };
 
 __XDISPATCH_END_NAMESPACE
@@ -0,0 +1,132 @@
+/*
+ * keyed_queue.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XDISPATCH_KEYED_QUEUE_H_
+#define XDISPATCH_KEYED_QUEUE_H_
+
+/**
+ * @addtogroup xdispatch
+ * @{
+ */
+
+#include <functional>
+#include <vector>
+
+#include "xdispatch/dispatch.h"
+
+__XDISPATCH_BEGIN_NAMESPACE
+
+/**
+    Provides partitioned serial execution of operations.
+
+    Every operation is queued using a key. Operations sharing the same key
+    are executed in the order they were queued, operations with different
+    keys may execute in parallel.
+
+    Keys are hashed onto a fixed number of serial queues (lanes) which are
+    created once, i.e. queueing an operation for a new key does not involve
+    any allocation besides what queueing on the lane itself needs. Keys
+    sharing a lane will be executed serially with respect to each other, so
+    the number of lanes should be chosen significantly larger than the
+    expected parallelism.
+*/
+class XDISPATCH_EXPORT keyed_queue
+{
+public:
+    /**
+        @brief Creates a new keyed queue using private serial queues as lanes
+
+        The lanes will be created using the platform default backend
+
+        @param label The label to assign to the queue and its lanes
+        @param lane_count The number of lanes to create, needs to be at
+                          least 1
+        @param priority The priority to assign to the lanes
+     */
+    keyed_queue(const std::string& label,
+                size_t lane_count,
+                queue_priority priority = queue_priority::DEFAULT);
+
+    /**
+        @brief Creates a new keyed queue using the provided queues as lanes
+
+        @param label The label to assign to the queue
+        @param lanes The serial queues to distribute the keys on, needs to
+                     contain at least one queue
+     */
+    keyed_queue(const std::string& label, const std::vector<queue>& lanes);
+
+    /**
+        Will dispatch the given operation for async execution after all
+        operations previously queued for the same key and return immediately.
+     */
+    template<typename Key>
+    inline void async(const Key& key, const operation_ptr& op) const
+    {
+        lane_for_hash(std::hash<Key>()(key)).async(op);
+    }
+
+    /**
+        @see async(Key, operation_ptr).
+
+        Will forward the given function to the lane of the given key,
+        i.e. it is queued the same way queue::async(Func&&) would queue it.
+    */
+    template<typename Key, typename Func>
+    inline void async(const Key& key, Func&& f) const
+    {
+        lane_for_hash(std::hash<Key>()(key)).async(std::forward<Func>(f));
+    }
+
+    /**
+        @returns The serial queue the given key is mapped to
+
+        This can be used to e.g. synchronize with all operations queued for
+        the given key.
+     */
+    template<typename Key>
+    inline const queue& lane(const Key& key) const
+    {
+        return lane_for_hash(std::hash<Key>()(key));
+    }
+
+    /**
+        @returns The number of lanes keys are distributed on
+     */
+    size_t lane_count() const;
+
+    /**
+        @return The label of the queue that was used while creating it
+    */
+    std::string label() const;
+
+private:
+    const queue& lane_for_hash(size_t hash) const;
+
+    std::vector<queue> m_lanes;
+    std::string m_label;
+};
+
+__XDISPATCH_END_NAMESPACE
+
+/** @} */
+
+#endif /* XDISPATCH_KEYED_QUEUE_H_ */
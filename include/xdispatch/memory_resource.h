@@ -0,0 +1,234 @@
+/*
+ * memory_resource.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef XDISPATCH_MEMORY_RESOURCE_H_
+#define XDISPATCH_MEMORY_RESOURCE_H_
+
+/**
+ * @addtogroup xdispatch
+ * @{
+ */
+
+#include "dispatch_decl.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+    #if __has_include(<memory_resource>)
+        #include <memory_resource>
+        #define XDISPATCH_HAVE_STD_PMR 1
+    #endif
+#endif
+
+__XDISPATCH_BEGIN_NAMESPACE
+
+/**
+  An interface to a source of memory, modelled after
+  std::pmr::memory_resource so that it can be used with C++14
+
+  The memory used internally by xdispatch (e.g. for operations created
+  on behalf of a queue, buffers of queued operations or group
+  bookkeeping) is obtained from a memory_resource. Resources can be set
+  per queue, per threadpool of the naive backend or globally using
+  set_default_resource().
+
+  Implementations need to be threadsafe. Memory is always returned to
+  the resource it was obtained from, which needs to outlive all queues
+  and operations using it.
+  */
+class XDISPATCH_EXPORT memory_resource
+{
+public:
+    memory_resource() = default;
+    memory_resource(const memory_resource&) = default;
+    virtual ~memory_resource() = default;
+
+    memory_resource& operator=(const memory_resource&) = default;
+
+    /**
+        @returns A block of at least the given size and alignment
+        @throws std::bad_alloc if no memory could be obtained
+     */
+    void* allocate(size_t bytes,
+                   size_t alignment = alignof(std::max_align_t))
+    {
+        return do_allocate(bytes, alignment);
+    }
+
+    /**
+        @brief Releases a block obtained from allocate() with the same
+               size and alignment
+     */
+    void deallocate(void* ptr,
+                    size_t bytes,
+                    size_t alignment = alignof(std::max_align_t))
+    {
+        do_deallocate(ptr, bytes, alignment);
+    }
+
+    /**
+        @returns true if memory allocated from this resource can be
+                 released via other and vice versa
+     */
+    bool is_equal(const memory_resource& other) const noexcept
+    {
+        return do_is_equal(other);
+    }
+
+protected:
+    virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+
+    virtual void do_deallocate(void* ptr, size_t bytes, size_t alignment) = 0;
+
+    virtual bool do_is_equal(const memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+};
+
+/**
+  @returns A resource using the global operator new and delete
+
+  This is the default resource unless changed via set_default_resource().
+  */
+XDISPATCH_EXPORT memory_resource*
+new_delete_resource() noexcept;
+
+/**
+  @returns The resource used whenever no other resource was given
+  */
+XDISPATCH_EXPORT memory_resource*
+get_default_resource() noexcept;
+
+/**
+  @brief Replaces the resource used whenever no other resource was given
+
+  Passing nullptr restores new_delete_resource(). Memory obtained before
+  will still be returned to the resource it was allocated from.
+
+  @returns The previous default resource
+  */
+XDISPATCH_EXPORT memory_resource*
+set_default_resource(memory_resource* resource) noexcept;
+
+/**
+  A standard allocator obtaining its memory from a memory_resource,
+  modelled after std::pmr::polymorphic_allocator
+  */
+template<typename T>
+class polymorphic_allocator
+{
+public:
+    using value_type = T;
+
+    polymorphic_allocator() noexcept
+      : m_resource(get_default_resource())
+    {}
+
+    polymorphic_allocator(memory_resource* resource) noexcept
+      : m_resource(resource ? resource : get_default_resource())
+    {}
+
+    template<typename U>
+    polymorphic_allocator(const polymorphic_allocator<U>& other) noexcept
+      : m_resource(other.resource())
+    {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(m_resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept
+    {
+        m_resource->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    memory_resource* resource() const noexcept { return m_resource; }
+
+private:
+    memory_resource* m_resource;
+};
+
+template<typename T, typename U>
+inline bool
+operator==(const polymorphic_allocator<T>& a,
+           const polymorphic_allocator<U>& b) noexcept
+{
+    return a.resource() == b.resource() ||
+           a.resource()->is_equal(*b.resource());
+}
+
+template<typename T, typename U>
+inline bool
+operator!=(const polymorphic_allocator<T>& a,
+           const polymorphic_allocator<U>& b) noexcept
+{
+    return !(a == b);
+}
+
+#if (defined XDISPATCH_HAVE_STD_PMR)
+/**
+  Makes a std::pmr::memory_resource available to xdispatch
+  */
+class pmr_resource : public memory_resource
+{
+public:
+    explicit pmr_resource(std::pmr::memory_resource* upstream) noexcept
+      : memory_resource()
+      , m_upstream(upstream)
+    {}
+
+    std::pmr::memory_resource* upstream() const noexcept
+    {
+        return m_upstream;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        return m_upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override
+    {
+        m_upstream->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const memory_resource& other) const noexcept override
+    {
+        const auto* const o = dynamic_cast<const pmr_resource*>(&other);
+        return o && m_upstream->is_equal(*o->m_upstream);
+    }
+
+private:
+    std::pmr::memory_resource* const m_upstream;
+};
+#endif
+
+__XDISPATCH_END_NAMESPACE
+
+/** @} */
+
+#endif /* XDISPATCH_MEMORY_RESOURCE_H_ */
@@ -28,10 +28,14 @@
  */
 
 #include "dispatch_decl.h"
+#include "ref_ptr.h"
 
 #include <string>
 #include <memory>
 #include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
 
 __XDISPATCH_BEGIN_NAMESPACE
 
@@ -63,8 +67,12 @@ queue_operation_with_d(parameterized_operation<Params...>&, void*);
 
 /**
    @brief Common base class shared with all operations
+
+   Operations can be owned by either std::shared_ptr or ref_ptr, the
+   latter avoids allocating a separate control block when queued via
+   queue::async().
  */
-class XDISPATCH_EXPORT base_operation
+class XDISPATCH_EXPORT base_operation : public ref_counted
 {
 public:
     base_operation(const base_operation& other) = delete;
@@ -137,12 +145,14 @@ public:
 
     template<typename Func>
     inline static typename std::enable_if<
-      !std::is_convertible<Func, parameterized_operation_ptr<Params...>>::value,
+      !std::is_convertible<typename std::decay<Func>::type,
+                           parameterized_operation_ptr<Params...>>::value,
       parameterized_operation_ptr<Params...>>::type
-    make(const Func& f)
+    make(Func&& f)
     {
-        return std::make_shared<
-          function_parameterized_operation<Func, Params...>>(f);
+        return std::make_shared<function_parameterized_operation<
+          typename std::decay<Func>::type,
+          Params...>>(std::forward<Func>(f));
     }
 
     template<class T>
@@ -196,6 +206,11 @@ public:
       , m_function(b)
     {}
 
+    function_operation(Func&& b)
+      : operation()
+      , m_function(std::move(b))
+    {}
+
     function_operation(const function_operation& other) = default;
 
     ~function_operation() override = default;
@@ -234,11 +249,13 @@ make_operation(const operation_ptr& op)
 }
 
 template<typename Func>
-inline typename std::enable_if<!std::is_convertible<Func, operation_ptr>::value,
-                               operation_ptr>::type
-make_operation(const Func& f)
+inline typename std::enable_if<
+  !std::is_convertible<typename std::decay<Func>::type, operation_ptr>::value,
+  operation_ptr>::type
+make_operation(Func&& f)
 {
-    return std::make_shared<function_operation<Func>>(f);
+    using stored = typename std::decay<Func>::type;
+    return std::make_shared<function_operation<stored>>(std::forward<Func>(f));
 }
 
 template<class T>
@@ -248,6 +265,320 @@ make_operation(T* object, void (T::*function)())
     return std::make_shared<member_operation<T>>(object, function);
 }
 
+/**
+  An operation forwarding to another operation owned by std::shared_ptr
+  */
+class shared_operation : public operation
+{
+public:
+    explicit shared_operation(const operation_ptr& op)
+      : operation()
+      , m_op(op)
+    {}
+
+    void operator()() final { execute_operation_on_this_thread(*m_op); }
+
+private:
+    const operation_ptr m_op;
+};
+
+/**
+  @returns A ref_ptr referencing the given operation
+
+  Operations owned by a ref_ptr already are referenced directly, all
+  others get wrapped in a newly allocated shared_operation.
+  */
+inline ref_ptr<operation>
+to_ref(const operation_ptr& op)
+{
+    if (!op) {
+        return ref_ptr<operation>();
+    }
+    if (op->is_ref_counted()) {
+        // the shared_ptr holds a reference on its own
+        return ref_ptr<operation>(op.get());
+    }
+    return make_ref<shared_operation>(op);
+}
+
+class inline_operation;
+
+/**
+  Will synchronously execute the given inline_operation on the current
+  thread
+  */
+inline void
+execute_operation_on_this_thread(inline_operation&);
+
+/**
+  Holds a single operation with exclusive ownership
+
+  Function objects of up to capacity bytes are stored inline so that
+  no allocation is needed to pass them to a queue. All other function
+  objects and any operation instances are referenced via operation_ptr
+  or ref_ptr instead. An inline_operation can only be moved, never
+  copied.
+  */
+class inline_operation
+{
+public:
+    /**
+        @brief The number of bytes available to store a function object
+     */
+    static constexpr size_t capacity = 48;
+
+    /**
+        @brief Tests if a function object of the given type is stored inline
+     */
+    template<typename Func>
+    struct fits_inline
+      : std::integral_constant<
+          bool,
+          sizeof(Func) <= capacity &&
+            alignof(Func) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible<Func>::value>
+    {};
+
+    /**
+        @brief Creates an empty inline_operation
+     */
+    inline_operation() noexcept
+      : m_vtable(nullptr)
+    {}
+
+    /**
+        @brief Creates an inline_operation referencing the given operation
+     */
+    explicit inline_operation(const operation_ptr& op)
+      : m_vtable(nullptr)
+    {
+        if (op) {
+            construct<operation_ptr>(op);
+        }
+    }
+
+    /**
+        @brief Creates an inline_operation taking over the given operation
+     */
+    explicit inline_operation(operation_ptr&& op)
+      : m_vtable(nullptr)
+    {
+        if (op) {
+            construct<operation_ptr>(std::move(op));
+        }
+    }
+
+    /**
+        @brief Creates an inline_operation taking over the given reference
+     */
+    template<typename T,
+             typename = typename std::enable_if<
+               std::is_convertible<T*, operation*>::value>::type>
+    explicit inline_operation(ref_ptr<T> op)
+      : m_vtable(nullptr)
+    {
+        if (op) {
+            construct<ref_ptr<operation>>(std::move(op));
+        }
+    }
+
+    inline_operation(const inline_operation&) = delete;
+
+    inline_operation(inline_operation&& other) noexcept
+      : m_vtable(nullptr)
+    {
+        take(other);
+    }
+
+    ~inline_operation() { reset(); }
+
+    inline_operation& operator=(const inline_operation&) = delete;
+
+    inline_operation& operator=(inline_operation&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    /**
+        @returns an inline_operation holding the given function object,
+                 stored inline whenever it fits
+     */
+    template<typename Func,
+             typename Stored = typename std::decay<Func>::type>
+    static inline typename std::enable_if<
+      fits_inline<Stored>::value &&
+        !std::is_convertible<Stored, operation_ptr>::value &&
+        !is_ref_ptr<Stored>::value,
+      inline_operation>::type
+    make(Func&& f)
+    {
+        inline_operation op;
+        op.construct<Stored>(std::forward<Func>(f));
+        return op;
+    }
+
+    template<typename Func,
+             typename Stored = typename std::decay<Func>::type>
+    static inline typename std::enable_if<
+      (!fits_inline<Stored>::value ||
+       std::is_convertible<Stored, operation_ptr>::value) &&
+        !is_ref_ptr<Stored>::value,
+      inline_operation>::type
+    make(Func&& f)
+    {
+        return inline_operation(make_operation(std::forward<Func>(f)));
+    }
+
+    template<typename T>
+    static inline inline_operation make(ref_ptr<T> op)
+    {
+        return inline_operation(std::move(op));
+    }
+
+    /**
+        @returns true if an operation is held
+     */
+    explicit operator bool() const { return nullptr != m_vtable; }
+
+    /**
+        @brief Destroys the held operation, if any
+     */
+    void reset() noexcept
+    {
+        if (m_vtable) {
+            m_vtable->destroy(m_storage);
+            m_vtable = nullptr;
+        }
+    }
+
+    /**
+        @returns the held operation as operation_ptr and leaves this
+                 inline_operation empty
+
+        Function objects stored inline are moved to a newly allocated
+        operation, use this only where an operation_ptr is required.
+     */
+    operation_ptr release()
+    {
+        if (!m_vtable) {
+            return operation_ptr();
+        }
+        auto op = m_vtable->release(m_storage);
+        reset();
+        return op;
+    }
+
+private:
+    struct vtable
+    {
+        void (*invoke)(void*);
+        void (*relocate)(void* to, void* from);
+        void (*destroy)(void*);
+        operation_ptr (*release)(void*);
+    };
+
+    template<typename T>
+    struct vtable_for
+    {
+        static const vtable value;
+    };
+
+    alignas(std::max_align_t) unsigned char m_storage[capacity];
+    const vtable* m_vtable;
+
+    template<typename T, typename Arg>
+    void construct(Arg&& value)
+    {
+        static_assert(fits_inline<T>::value, "Type cannot be stored inline");
+        new (m_storage) T(std::forward<Arg>(value));
+        m_vtable = &vtable_for<T>::value;
+    }
+
+    void take(inline_operation& other) noexcept
+    {
+        if (other.m_vtable) {
+            other.m_vtable->relocate(m_storage, other.m_storage);
+            m_vtable = other.m_vtable;
+            other.m_vtable = nullptr;
+        }
+    }
+
+    static void call(operation_ptr& op)
+    {
+        execute_operation_on_this_thread(*op);
+    }
+
+    static void call(ref_ptr<operation>& op)
+    {
+        execute_operation_on_this_thread(*op);
+    }
+
+    template<typename Func>
+    static void call(const Func& f)
+    {
+        f();
+    }
+
+    static operation_ptr to_operation(operation_ptr& op)
+    {
+        return std::move(op);
+    }
+
+    static operation_ptr to_operation(ref_ptr<operation>& op) { return op; }
+
+    template<typename Func>
+    static operation_ptr to_operation(Func& f)
+    {
+        return std::make_shared<function_operation<Func>>(std::move(f));
+    }
+
+    template<typename T>
+    static void invoke_as(void* storage)
+    {
+        call(*static_cast<T*>(storage));
+    }
+
+    template<typename T>
+    static void relocate_as(void* to, void* from)
+    {
+        auto* const value = static_cast<T*>(from);
+        new (to) T(std::move(*value));
+        value->~T();
+    }
+
+    template<typename T>
+    static void destroy_as(void* storage)
+    {
+        static_cast<T*>(storage)->~T();
+    }
+
+    template<typename T>
+    static operation_ptr release_as(void* storage)
+    {
+        return to_operation(*static_cast<T*>(storage));
+    }
+
+    friend void execute_operation_on_this_thread(inline_operation&);
+};
+
+template<typename T>
+const inline_operation::vtable inline_operation::vtable_for<T>::value = {
+    &inline_operation::invoke_as<T>,
+    &inline_operation::relocate_as<T>,
+    &inline_operation::destroy_as<T>,
+    &inline_operation::release_as<T>
+};
+
+inline void
+execute_operation_on_this_thread(inline_operation& op)
+{
+    op.m_vtable->invoke(op.m_storage);
+}
+
 /**
   A simple parameterized operation needed when
   applying a function object several times
@@ -257,11 +588,16 @@ class function_parameterized_operation
   : public parameterized_operation<Params...>
 {
 public:
-    function_parameterized_operation(const Func b)
+    function_parameterized_operation(const Func& b)
       : parameterized_operation<Params...>()
       , m_function(b)
     {}
 
+    function_parameterized_operation(Func&& b)
+      : parameterized_operation<Params...>()
+      , m_function(std::move(b))
+    {}
+
     function_parameterized_operation(
       const function_parameterized_operation& other) = default;
 
@@ -308,11 +644,12 @@ make_iteration_operation(const iteration_operation_ptr& op)
 
 template<typename Func>
 inline typename std::enable_if<
-  !std::is_convertible<Func, iteration_operation_ptr>::value,
+  !std::is_convertible<typename std::decay<Func>::type,
+                       iteration_operation_ptr>::value,
   iteration_operation_ptr>::type
-make_iteration_operation(const Func& f)
+make_iteration_operation(Func&& f)
 {
-    return iteration_operation::make(f);
+    return iteration_operation::make(std::forward<Func>(f));
 }
 
 template<class T>
@@ -0,0 +1,125 @@
+/*
+ * prioritized_queue.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XDISPATCH_PRIORITIZED_QUEUE_H_
+#define XDISPATCH_PRIORITIZED_QUEUE_H_
+
+/**
+ * @addtogroup xdispatch
+ * @{
+ */
+
+#include "xdispatch/dispatch.h"
+
+__XDISPATCH_BEGIN_NAMESPACE
+
+/**
+    Provides a serial queue executing operations ordered by an urgency.
+
+    Every operation is queued using an urgency, the pending operation with
+    the highest urgency is executed next. Operations of equal urgency are
+    executed in the order they were queued. An operation that already
+    started executing is never interrupted, i.e. operations still execute
+    one after another.
+
+    Operations are buffered in a heap guarded by a single lock, so
+    queueing an operation or picking the next one takes logarithmic time
+    in the number of operations waiting and concurrent producers are
+    serialized. Operations queued via async(operation_ptr) are assigned
+    the default_urgency.
+
+    @remark The urgency only affects the order of execution within this
+    queue, use the queue_priority to affect the priority of the threads
+    executing the operations.
+
+    @remark Operations queued via sync(), apply() or barrier_async() are
+    passed to the inner queue directly. Waiting operations are executed
+    in batches of limited size, i.e. these may be executed before some
+    of the operations waiting already.
+*/
+class XDISPATCH_EXPORT prioritized_queue : public queue
+{
+public:
+    /**
+        @brief The urgency assigned to operations queued without one
+     */
+    static constexpr int default_urgency = 0;
+
+    /**
+        @brief Creates a new prioritized queue using a private serial
+               queue for delegation
+
+        The queue will be created using the platform default backend
+
+        @param label The name to be given to the private queue
+        @param priority The priority to assign to the new queue
+     */
+    explicit prioritized_queue(
+      const std::string& label,
+      queue_priority priority = queue_priority::DEFAULT);
+
+    /**
+        @brief Creates a new prioritized queue delegating to the provided
+               queue
+
+        @param label The label to assign to this queue
+        @param inner_queue The queue to be used for execution, needs to be
+                           a serial queue to guarantee mutual exclusion
+     */
+    prioritized_queue(const std::string& label, const queue& inner_queue);
+
+    using queue::async;
+
+    /**
+        Will dispatch the given operation for async execution with the
+        given urgency and return immediately.
+
+        @param urgency Operations with a higher urgency are executed first
+     */
+    void async(int urgency, const operation_ptr& op) const;
+
+    /**
+        @see async(int, operation_ptr).
+
+        Will wrap the given function in an operation and put it on the
+        queue using the given urgency.
+    */
+    template<typename Func>
+    inline void async(int urgency, Func&& f) const
+    {
+        const auto op = make_operation(std::forward<Func>(f));
+        async(urgency, op);
+    }
+
+    /**
+        @returns The number of operations currently waiting for execution
+     */
+    size_t depth() const;
+
+private:
+    class impl;
+};
+
+__XDISPATCH_END_NAMESPACE
+
+/** @} */
+
+#endif /* XDISPATCH_PRIORITIZED_QUEUE_H_ */
@@ -87,17 +87,164 @@ public:
       */
     void async(const operation_ptr& op) const;
 
+    /**
+        @see async(operation_ptr).
+
+        Will put the given inline_operation on the queue. Backends able to
+       store it directly will not need to allocate memory for it.
+      */
+    void async(inline_operation&& op) const;
+
     /**
         @see async(operation_ptr).
 
         Will put the given function on the queue.
         The group and queue will be retained by the system until the operation
        was executed.
+
+        Functions of up to inline_operation::capacity bytes are stored
+       without allocating memory on the naive backend. Operations passed
+       as ref_ptr are queued without allocating a control block.
+    */
+    template<typename Func>
+    inline void async(Func&& f) const
+    {
+        async(inline_operation::make(std::forward<Func>(f)));
+    }
+
+    /**
+        Will dispatch the given operation for async execution on the queue
+       and return immediately.
+
+        Should the operation not have started executing once the given
+       deadline passed, it will be dropped instead. The optional on_expired
+       operation is executed in its place on the thread that dropped it.
+       Dropped operations are counted, see expired().
+
+        @param deadline The latest point in time to start executing
+      */
+    void async(const operation_ptr& op,
+               std::chrono::steady_clock::time_point deadline,
+               const operation_ptr& on_expired = operation_ptr()) const;
+
+    /**
+        @see async(operation_ptr, std::chrono::steady_clock::time_point,
+       operation_ptr).
+
+        Will wrap the given function in an operation and put it on the queue
+       to be executed before the given deadline.
+    */
+    template<typename Func>
+    inline void async(Func&& f,
+                      std::chrono::steady_clock::time_point deadline) const
+    {
+        const auto op = make_operation(std::forward<Func>(f));
+        async(op, deadline);
+    }
+
+    /**
+        Will dispatch the given operation for async execution on the queue
+       and return immediately.
+
+        Should the token be cancelled before the operation started
+       executing, the operation will be skipped without being invoked.
+       Backends able to store an inline_operation will not allocate any
+       memory for attaching the token.
+
+        @param token The token to test before executing the operation
+      */
+    void async(const operation_ptr& op, const cancellation_token& token) const;
+
+    /**
+        @see async(operation_ptr, cancellation_token).
+
+        Will wrap the given function in an operation and put it on the queue
+       to be skipped once the token was cancelled.
+    */
+    template<typename Func>
+    inline void async(Func&& f, const cancellation_token& token) const
+    {
+        const auto op = make_operation(std::forward<Func>(f));
+        async(op, token);
+    }
+
+    /**
+        Will try to dispatch the given operation for async execution on the
+       queue and return immediately.
+
+        Only queues with a limited capacity (e.g. a bounded_queue) will
+       ever refuse an operation, all other queues behave like async().
+
+        @returns true if the operation was queued
+      */
+    bool try_async(const operation_ptr& op) const;
+
+    /**
+        @see try_async(operation_ptr).
+
+        Will wrap the given function in an operation and try to put it on
+       the queue.
+    */
+    template<typename Func>
+    inline bool try_async(Func&& f) const
+    {
+        const auto op = make_operation(std::forward<Func>(f));
+        return try_async(op);
+    }
+
+    /**
+        Will dispatch the given operation as a barrier on the queue and
+       return immediately.
+
+        All operations queued before the barrier will have completed before
+       the barrier gets executed. The barrier will execute on its own and
+       operations queued after it will only start once it completed. This
+       allows to implement reader/writer schemes on parallel queues with
+       readers queued via async() and writers via barrier_async().
+
+        On serial queues this is identical to async(). The global queues
+       are shared by all users and behave like async() as well, the same
+       as any queue of a backend unable to provide barriers for it.
+
+        The queue will be retained by the system until the operation was
+       executed.
+      */
+    void barrier_async(const operation_ptr& op) const;
+
+    /**
+        @see barrier_async(operation_ptr).
+
+        Will put the given function on the queue as a barrier.
+    */
+    template<typename Func>
+    inline void barrier_async(Func&& f) const
+    {
+        const auto op = make_operation(std::forward<Func>(f));
+        barrier_async(op);
+    }
+
+    /**
+        Will dispatch the given operation for execution on the queue and
+       wait until it completed.
+
+        Depending on the backend the operation may get executed directly on
+       the calling thread if the queue is idle. Backends other than naive
+       will deadlock if invoked from within an operation executing on the
+       same serial queue.
+      */
+    void sync(const operation_ptr& op) const;
+
+    /**
+        @see sync(operation_ptr).
+
+        Will wrap the given function in an operation and execute it on the
+       queue.
     */
     template<typename Func>
-    inline void async(const Func& f) const
+    inline void sync(Func&& f) const
     {
-        async(make_operation(f));
+        const auto op = make_operation(std::forward<Func>(f));
+        sync(op);
     }
 
     /**
@@ -115,9 +262,37 @@ public:
         Will wrap the given function in an operation and put it on the queue.
     */
     template<typename Func>
-    inline void apply(size_t times, const Func& f) const
+    inline void apply(size_t times, Func&& f) const
+    {
+        const auto op = make_iteration_operation(std::forward<Func>(f));
+        apply(times, op);
+    }
+
+    /**
+        @see apply(size_t, iteration_operation_ptr).
+
+        Iterations not started once the token was cancelled will be skipped
+       without being invoked. The call returns once all remaining
+       iterations were skipped.
+
+        @param token The token to test before executing an iteration
+    */
+    void apply(size_t times,
+               const iteration_operation_ptr& op,
+               const cancellation_token& token) const;
+
+    /**
+        @see apply(size_t, iteration_operation_ptr, cancellation_token).
+
+        Will wrap the given function in an operation and put it on the queue.
+    */
+    template<typename Func>
+    inline void apply(size_t times,
+                      Func&& f,
+                      const cancellation_token& token) const
     {
-        apply(times, make_iteration_operation(f));
+        const auto op = make_iteration_operation(std::forward<Func>(f));
+        apply(times, op, token);
     }
 
     /**
@@ -139,9 +314,10 @@ public:
         queue for execution as soon as the delay expired.
     */
     template<typename Func>
-    inline void after(std::chrono::milliseconds delay, const Func& f) const
+    inline void after(std::chrono::milliseconds delay, Func&& f) const
     {
-        after(delay, make_operation(f));
+        const auto op = make_operation(std::forward<Func>(f));
+        after(delay, op);
     }
 
     /**
@@ -149,6 +325,52 @@ public:
     */
     std::string label() const;
 
+    /**
+        @return The priority operations of this queue are executed with
+    */
+    queue_priority priority() const;
+
+    /**
+        @return The number of operations dropped by this queue as their
+                deadline passed before they could be executed
+    */
+    size_t expired() const;
+
+    /**
+        Associates the given value with the key on this queue.
+
+        Keys are compared by address only, e.g. use the address of a static
+       variable. The queue does not take ownership of the value.
+       Passing nullptr as value clears the association.
+
+        @see current_specific(const void*)
+    */
+    void set_specific(const void* key, void* value) const;
+
+    /**
+        @return The value associated with the given key on this queue or
+                nullptr if there is none
+    */
+    void* get_specific(const void* key) const;
+
+    /**
+        @return The value associated with the given key on the queue
+                executing the calling code or nullptr if there is none
+
+        This is intended to attach context to queues which can be looked up
+       by the operations executing on them. Only queues of the naive backend
+       (and those of the qt backend building on it) report themselves as
+       executing, on all other backends nullptr is returned.
+    */
+    static void* current_specific(const void* key);
+
+    /**
+        @return true if the calling code is executed by this queue
+
+        @see current_specific(const void*) for the backends supporting this
+    */
+    bool is_current() const;
+
     /**
         @brief Assignment operator
     */
@@ -0,0 +1,268 @@
+/*
+ * ref_ptr.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef XDISPATCH_REF_PTR_H_
+#define XDISPATCH_REF_PTR_H_
+
+/**
+ * @addtogroup xdispatch
+ * @{
+ */
+
+#include "dispatch_decl.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+__XDISPATCH_BEGIN_NAMESPACE
+
+template<typename T>
+class ref_ptr;
+
+/**
+  Provides an intrusive reference count to derived classes
+
+  Objects referenced via ref_ptr keep their reference count in this
+  base class, so that no separate control block needs to be allocated
+  and passing a reference on requires at most a single atomic
+  operation.
+
+  The count of objects owned by std::shared_ptr only is always zero.
+  */
+class XDISPATCH_EXPORT ref_counted
+{
+public:
+    ref_counted(const ref_counted& other) = delete;
+    ref_counted& operator=(const ref_counted& other) = delete;
+
+    /**
+        @returns true if the object is owned by at least one ref_ptr
+     */
+    bool is_ref_counted() const { return 0 != m_refs.load(); }
+
+protected:
+    ref_counted() noexcept
+      : m_refs(0)
+    {}
+
+    ~ref_counted() = default;
+
+private:
+    mutable std::atomic<size_t> m_refs;
+
+    template<typename T>
+    friend class ref_ptr;
+};
+
+/**
+  A smart pointer to an object derived from ref_counted
+
+  Behaves like std::shared_ptr but keeps the reference count within the
+  referenced object. A ref_ptr converts to a std::shared_ptr whenever
+  one is required, the std::shared_ptr will then hold a reference of
+  its own.
+
+  Only queue::async() and inline_operation take a ref_ptr without the
+  conversion. All other entry points, e.g. queue::sync(),
+  queue::try_async(), queue::barrier_async() or group::async(), accept
+  an operation_ptr and allocate a control block for the conversion.
+
+  Create instances using make_ref().
+  */
+template<typename T>
+class ref_ptr
+{
+public:
+    using element_type = T;
+
+    constexpr ref_ptr() noexcept
+      : m_ptr(nullptr)
+    {}
+
+    constexpr ref_ptr(std::nullptr_t) noexcept
+      : m_ptr(nullptr)
+    {}
+
+    /**
+        @brief Adds a reference to the given object
+
+        The object must either be newly allocated or already be owned
+        by another ref_ptr. Never pass objects owned by std::shared_ptr
+        only, as both would attempt to delete it.
+     */
+    explicit ref_ptr(T* ptr) noexcept
+      : m_ptr(ptr)
+    {
+        retain();
+    }
+
+    ref_ptr(const ref_ptr& other) noexcept
+      : m_ptr(other.m_ptr)
+    {
+        retain();
+    }
+
+    ref_ptr(ref_ptr&& other) noexcept
+      : m_ptr(other.m_ptr)
+    {
+        other.m_ptr = nullptr;
+    }
+
+    template<typename U,
+             typename = typename std::enable_if<
+               std::is_convertible<U*, T*>::value>::type>
+    ref_ptr(const ref_ptr<U>& other) noexcept
+      : m_ptr(other.m_ptr)
+    {
+        retain();
+    }
+
+    template<typename U,
+             typename = typename std::enable_if<
+               std::is_convertible<U*, T*>::value>::type>
+    ref_ptr(ref_ptr<U>&& other) noexcept
+      : m_ptr(other.m_ptr)
+    {
+        other.m_ptr = nullptr;
+    }
+
+    ~ref_ptr() { release(m_ptr); }
+
+    ref_ptr& operator=(const ref_ptr& other) noexcept
+    {
+        ref_ptr(other).swap(*this);
+        return *this;
+    }
+
+    ref_ptr& operator=(ref_ptr&& other) noexcept
+    {
+        ref_ptr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    /**
+        @brief Drops the reference held, if any
+     */
+    void reset() noexcept { ref_ptr().swap(*this); }
+
+    void swap(ref_ptr& other) noexcept { std::swap(m_ptr, other.m_ptr); }
+
+    T* get() const noexcept { return m_ptr; }
+
+    T& operator*() const noexcept { return *m_ptr; }
+
+    T* operator->() const noexcept { return m_ptr; }
+
+    explicit operator bool() const noexcept { return nullptr != m_ptr; }
+
+    /**
+        @returns The number of references to the object, including those
+                 held by std::shared_ptr instances converted from a ref_ptr
+     */
+    size_t use_count() const noexcept
+    {
+        return m_ptr ? m_ptr->m_refs.load() : 0;
+    }
+
+    /**
+        @returns A std::shared_ptr holding a reference to the object
+
+        This allocates a control block, keep using ref_ptr wherever
+        possible.
+     */
+    template<typename U,
+             typename = typename std::enable_if<
+               std::is_convertible<T*, U*>::value>::type>
+    operator std::shared_ptr<U>() const
+    {
+        if (!m_ptr) {
+            return std::shared_ptr<U>();
+        }
+        retain();
+        return std::shared_ptr<U>(m_ptr, &ref_ptr::release);
+    }
+
+private:
+    T* m_ptr;
+
+    void retain() const noexcept
+    {
+        if (m_ptr) {
+            m_ptr->m_refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void release(T* ptr) noexcept
+    {
+        if (ptr && 1 == ptr->m_refs.fetch_sub(1, std::memory_order_acq_rel)) {
+            delete ptr;
+        }
+    }
+
+    template<typename U>
+    friend class ref_ptr;
+};
+
+template<typename T, typename U>
+inline bool
+operator==(const ref_ptr<T>& a, const ref_ptr<U>& b) noexcept
+{
+    return a.get() == b.get();
+}
+
+template<typename T, typename U>
+inline bool
+operator!=(const ref_ptr<T>& a, const ref_ptr<U>& b) noexcept
+{
+    return a.get() != b.get();
+}
+
+/**
+  Tests if the given type is a ref_ptr
+  */
+template<typename T>
+struct is_ref_ptr : std::false_type
+{};
+
+template<typename T>
+struct is_ref_ptr<ref_ptr<T>> : std::true_type
+{};
+
+/**
+  @returns A ref_ptr owning a newly allocated T constructed from the
+           given arguments
+  */
+template<typename T, typename... Args>
+inline ref_ptr<T>
+make_ref(Args&&... args)
+{
+    return ref_ptr<T>(new T(std::forward<Args>(args)...));
+}
+
+__XDISPATCH_END_NAMESPACE
+
+/** @} */
+
+#endif /* XDISPATCH_REF_PTR_H_ */
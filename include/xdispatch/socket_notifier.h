@@ -167,9 +167,10 @@ public:
         the notifier becomes ready.
     */
     template<typename Func>
-    inline void handler(const Func& f)
+    inline void handler(Func&& f)
     {
-        handler(socket_notifier_operation::make(f));
+        const auto op = socket_notifier_operation::make(std::forward<Func>(f));
+        handler(op);
     }
 
     /**
@@ -163,9 +163,10 @@ public:
         the timer becomes ready.
     */
     template<typename Func>
-    inline void handler(const Func& f)
+    inline void handler(Func&& f)
     {
-        handler(make_operation(f));
+        const auto op = make_operation(std::forward<Func>(f));
+        handler(op);
     }
 
     /**
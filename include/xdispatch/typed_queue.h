@@ -0,0 +1,270 @@
+/*
+ * typed_queue.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef XDISPATCH_TYPED_QUEUE_H_
+#define XDISPATCH_TYPED_QUEUE_H_
+
+/**
+ * @addtogroup xdispatch
+ * @{
+ */
+
+#include <iterator>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "xdispatch/dispatch.h"
+#include "xdispatch/impl/iqueue_impl.h"
+
+__XDISPATCH_BEGIN_NAMESPACE
+
+/**
+    Handles a stream of messages of type Msg using a handler of type
+    Handler known at compile time.
+
+    Intended for high rates of homogeneous messages. Instead of wrapping
+    every message in an operation of its own, messages are stored by value
+    in a contiguous buffer and passed to the handler directly, i.e. neither
+    type erasure nor virtual calls are involved per message. A single
+    operation is dispatched to the target queue for a whole batch of
+    messages. Buffers are reused, so no memory is allocated once they grew
+    to the typical batch size. Memory is obtained from the memory_resource
+    of the target queue.
+
+    Messages are handled one after another in the order they were queued,
+    even if the target queue is a parallel queue. After every batch the
+    worker yields to other operations queued on the target queue.
+
+    Copies of a typed_worker refer to the same messages. Pending messages
+    will still be handled after all copies were destroyed. Should the
+    handler throw, the messages queued after the failing one are requeued
+    and the exception is passed on to the target queue. Whether they are
+    handled depends on the backend surviving that exception, the naive
+    backend e.g. terminates the process.
+*/
+template<typename Msg, typename Handler>
+class typed_worker
+{
+public:
+    using message_type = Msg;
+    using handler_type = Handler;
+
+    /**
+        @param target The queue to handle the messages on
+        @param handler The handler invoked as handler(Msg&&) for every
+                       message
+        @param reserve The number of messages to reserve space for
+     */
+    typed_worker(const queue& target, Handler handler, size_t reserve = 64)
+      : m_state(make_state(target, std::move(handler), reserve))
+    {}
+
+    /**
+        @brief Queues a copy of the given message and returns immediately
+     */
+    void async(const Msg& msg) const { emplace(msg); }
+
+    /**
+        @brief Queues the given message and returns immediately
+     */
+    void async(Msg&& msg) const { emplace(std::move(msg)); }
+
+    /**
+        @brief Queues a message constructed in place from the given
+               arguments and returns immediately
+     */
+    template<typename... Args>
+    void emplace(Args&&... args) const
+    {
+        std::unique_lock<std::mutex> lock(m_state->m_CS);
+        m_state->m_queued.emplace_back(std::forward<Args>(args)...);
+        if (m_state->m_scheduled) {
+            // the drain in flight will pick up the message
+            return;
+        }
+        m_state->m_scheduled = true;
+        lock.unlock();
+        schedule(m_state);
+    }
+
+    /**
+        @returns The queue the messages are handled on
+     */
+    const queue& target() const { return m_state->m_target; }
+
+private:
+    using buffer = std::vector<Msg, polymorphic_allocator<Msg>>;
+
+    struct state
+    {
+        state(const queue& target,
+              Handler&& handler,
+              size_t reserve,
+              memory_resource* resource)
+          : m_target(target)
+          , m_handler(std::move(handler))
+          , m_CS()
+          , m_queued(polymorphic_allocator<Msg>(resource))
+          , m_scheduled(false)
+          , m_batch(polymorphic_allocator<Msg>(resource))
+        {
+            m_queued.reserve(reserve);
+            m_batch.reserve(reserve);
+        }
+
+        const queue m_target;
+        Handler m_handler;
+        std::mutex m_CS;
+        // messages not handled yet, protected by m_CS
+        buffer m_queued;
+        // set while a drain is queued or running, protected by m_CS
+        bool m_scheduled;
+        // messages being handled, only accessed by the drain
+        buffer m_batch;
+    };
+    using state_ptr = std::shared_ptr<state>;
+
+    static state_ptr make_state(const queue& target,
+                                Handler&& handler,
+                                size_t reserve)
+    {
+        auto* const resource = target.implementation()->resource();
+        return std::allocate_shared<state>(
+          polymorphic_allocator<state>(resource),
+          target,
+          std::move(handler),
+          reserve,
+          resource);
+    }
+
+    static void schedule(const state_ptr& s)
+    {
+        // stored inline by naive queues, scheduling does not allocate
+        s->m_target.async([s] { drain(s); });
+    }
+
+    static void drain(const state_ptr& s)
+    {
+        {
+            // take all messages queued so far and leave an empty
+            // buffer of the previous batch for queueing new ones
+            std::lock_guard<std::mutex> lock(s->m_CS);
+            s->m_batch.swap(s->m_queued);
+        }
+        size_t started = 0;
+        try {
+            for (auto& msg : s->m_batch) {
+                ++started;
+                s->m_handler(std::move(msg));
+            }
+        } catch (...) {
+            // keep the remaining messages before passing the exception
+            // on, completing from a destructor might terminate instead
+            complete(s, started);
+            throw;
+        }
+        complete(s, started);
+    }
+
+    static void complete(const state_ptr& s, size_t started)
+    {
+        auto& batch = s->m_batch;
+        const bool failed = started < batch.size();
+        if (!failed) {
+            batch.clear();
+        }
+
+        std::unique_lock<std::mutex> lock(s->m_CS);
+        if (failed) {
+            // the handler threw, messages not started yet go first
+            s->m_queued.insert(
+              s->m_queued.begin(),
+              std::make_move_iterator(batch.begin() + started),
+              std::make_move_iterator(batch.end()));
+            batch.clear();
+        }
+        if (s->m_queued.empty()) {
+            s->m_scheduled = false;
+            return;
+        }
+        lock.unlock();
+        schedule(s);
+    }
+
+    state_ptr m_state;
+};
+
+/**
+    @private handler of typed_serial_queue invoking the messages
+ */
+struct typed_invoke
+{
+    template<typename Func>
+    void operator()(Func&& f) const
+    {
+        f();
+    }
+};
+
+/**
+    A serial queue executing function objects of the single type Func
+
+    Works like a typed_worker treating every function object as a message
+    handled by invoking it. This allows to e.g. queue instances of a
+    struct providing an operator() without allocating or type erasing
+    them.
+
+    @see typed_worker
+*/
+template<typename Func>
+class typed_serial_queue : public typed_worker<Func, typed_invoke>
+{
+public:
+    /**
+        @param target The queue to execute the function objects on
+        @param reserve The number of function objects to reserve space for
+     */
+    explicit typed_serial_queue(const queue& target, size_t reserve = 64)
+      : typed_worker<Func, typed_invoke>(target, typed_invoke(), reserve)
+    {}
+};
+
+/**
+    @returns A typed_worker handling messages of type Msg using the
+             given handler, e.g. a lambda
+
+    @see typed_worker
+*/
+template<typename Msg, typename Handler>
+inline typed_worker<Msg, typename std::decay<Handler>::type>
+make_typed_worker(const queue& target, Handler&& handler, size_t reserve = 64)
+{
+    return typed_worker<Msg, typename std::decay<Handler>::type>(
+      target, std::forward<Handler>(handler), reserve);
+}
+
+__XDISPATCH_END_NAMESPACE
+
+/** @} */
+
+#endif /* XDISPATCH_TYPED_QUEUE_H_ */
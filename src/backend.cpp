@@ -158,6 +158,15 @@ global_queue_BACKGROUND()
     return queue(k_label_global_BACKGROUND, s_instance);
 }
 
+static queue
+global_queue_IDLE()
+{
+    static iqueue_impl_ptr s_instance =
+      platform_backend().create_parallel_queue(k_label_global_IDLE,
+                                               queue_priority::IDLE);
+    return queue(k_label_global_IDLE, s_instance);
+}
+
 queue
 global_queue(queue_priority p)
 {
@@ -171,6 +180,8 @@ global_queue(queue_priority p)
             return global_queue_UTILITY();
         case queue_priority::BACKGROUND:
             return global_queue_BACKGROUND();
+        case queue_priority::IDLE:
+            return global_queue_IDLE();
     }
     assert(false && "Should never reach this");
     std::abort();
@@ -19,6 +19,7 @@
  * limitations under the License.
  */
 
+#include "xdispatch_internal.h"
 #include "xdispatch/barrier_operation.h"
 
 __XDISPATCH_BEGIN_NAMESPACE
@@ -30,7 +31,9 @@ barrier_operation::barrier_operation()
 bool
 barrier_operation::wait(std::chrono::milliseconds timeout)
 {
-    return m_barrier.wait(timeout);
+    // waiting on a pool thread for an operation queued to the same
+    // pool will make progress by executing pending operations
+    return wait_helping(m_barrier, timeout);
 }
 
 bool
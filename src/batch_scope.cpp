@@ -0,0 +1,167 @@
+/*
+ * batch_scope.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "xdispatch_internal.h"
+#include "xdispatch/batch_scope.h"
+#include "xdispatch/impl/iqueue_impl.h"
+
+__XDISPATCH_USE_NAMESPACE
+
+// the outermost batch_scope active on this thread
+static thread_local batch_scope* s_active_scope = nullptr;
+
+constexpr size_t batch_scope::default_threshold;
+
+__XDISPATCH_BEGIN_NAMESPACE
+
+class batch_scope_access
+{
+public:
+    static void async(batch_scope* scope,
+                      const iqueue_impl_ptr& q_impl,
+                      inline_operation&& op)
+    {
+        for (auto& batch : scope->m_batches) {
+            if (batch.m_queue == q_impl) {
+                batch.m_ops.push_back(std::move(op));
+                if (batch.m_ops.size() >= scope->m_threshold) {
+                    scope->flush(batch);
+                }
+                return;
+            }
+        }
+        scope->m_batches.push_back({ q_impl, {} });
+        scope->m_batches.back().m_ops.push_back(std::move(op));
+        if (1 >= scope->m_threshold) {
+            scope->flush(scope->m_batches.back());
+        }
+    }
+
+    static void flush(const iqueue_impl* q_impl)
+    {
+        auto* const scope = s_active_scope;
+        if (!scope) {
+            return;
+        }
+
+        for (auto& batch : scope->m_batches) {
+            if (batch.m_queue.get() == q_impl) {
+                scope->flush(batch);
+                return;
+            }
+        }
+    }
+};
+
+__XDISPATCH_END_NAMESPACE
+
+batch_scope::batch_scope(size_t threshold)
+  : m_threshold(threshold)
+  , m_outermost(nullptr == s_active_scope)
+  , m_batches()
+{
+    XDISPATCH_ASSERT(m_threshold > 0);
+    if (m_outermost) {
+        s_active_scope = this;
+    }
+}
+
+batch_scope::~batch_scope()
+{
+    if (m_outermost) {
+        flush();
+        s_active_scope = nullptr;
+    }
+}
+
+void
+batch_scope::flush()
+{
+    if (!m_outermost) {
+        // while suspended, e.g. when flushed by an operation executed
+        // synchronously, submissions are not buffered and the batches of
+        // the outermost scope belong to the code further down the stack
+        if (s_active_scope) {
+            s_active_scope->flush();
+        }
+        return;
+    }
+
+    for (auto& batch : m_batches) {
+        flush(batch);
+    }
+    m_batches.clear();
+}
+
+void
+batch_scope::flush(batch& b)
+{
+    if (b.m_ops.empty()) {
+        return;
+    }
+
+    // queues wrapping other queues submit to them from within, these
+    // submissions need to pass through directly instead of being
+    // buffered again
+    suspended_batch_scope suspended;
+    b.m_queue->async_bulk(b.m_ops);
+    b.m_ops.clear();
+}
+
+suspended_batch_scope::suspended_batch_scope()
+  : m_suspended(s_active_scope)
+{
+    s_active_scope = nullptr;
+}
+
+suspended_batch_scope::~suspended_batch_scope()
+{
+    s_active_scope = m_suspended;
+}
+
+bool
+xdispatch::batch_async(const iqueue_impl_ptr& q_impl, const operation_ptr& op)
+{
+    auto* const scope = s_active_scope;
+    if (!scope) {
+        return false;
+    }
+    batch_scope_access::async(scope, q_impl, inline_operation(op));
+    return true;
+}
+
+bool
+xdispatch::batch_async(const iqueue_impl_ptr& q_impl, inline_operation& op)
+{
+    auto* const scope = s_active_scope;
+    if (!scope) {
+        return false;
+    }
+    batch_scope_access::async(scope, q_impl, std::move(op));
+    return true;
+}
+
+void
+xdispatch::flush_batch(const iqueue_impl* q_impl)
+{
+    batch_scope_access::flush(q_impl);
+}
@@ -0,0 +1,341 @@
+/*
+ * bounded_queue.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <list>
+#include <condition_variable>
+#include <mutex>
+
+#include "xdispatch_internal.h"
+#include "xdispatch/bounded_queue.h"
+#include "xdispatch/backend_naive_ithreadpool.h"
+#include "xdispatch/impl/iqueue_impl.h"
+#include "xdispatch/impl/itimer_impl.h"
+#include "trace_utils.h"
+
+__XDISPATCH_USE_NAMESPACE
+
+class bounded_queue_operation : public operation
+{
+public:
+    enum class admission
+    {
+        queued,
+        replaced,
+        rejected
+    };
+
+    bounded_queue_operation(size_t capacity, overflow_policy policy)
+      : m_CS()
+      , m_cond()
+      , m_operations()
+      , m_capacity(capacity)
+      , m_policy(policy)
+      , m_dropped(0)
+      , m_high(0)
+      , m_low(0)
+      , m_high_reached(false)
+      , m_on_high()
+      , m_on_low()
+    {
+        XDISPATCH_ASSERT(m_capacity > 0);
+    }
+
+    void operator()() override { drain_one(); }
+
+    void drain_one()
+    {
+        operation_ptr op;
+        operation_ptr low_handler;
+        {
+            std::lock_guard<std::mutex> lock(m_CS);
+            // there is one drain queued for every operation
+            // that was not replaced by another one
+            XDISPATCH_ASSERT(!m_operations.empty());
+            op = std::move(m_operations.front());
+            m_operations.pop_front();
+
+            if (m_high_reached && m_operations.size() <= m_low) {
+                m_high_reached = false;
+                low_handler = m_on_low;
+            }
+        }
+        m_cond.notify_one();
+
+        if (low_handler) {
+            execute_operation_on_this_thread(*low_handler);
+        }
+        execute_operation_on_this_thread(*op);
+    }
+
+    // async() counts refused operations as dropped and may wait
+    // for space unless it runs on the inner queue itself
+    admission add_one(const operation_ptr& op,
+                      bool may_wait,
+                      bool count_refused)
+    {
+        // release discarded operations outside the lock
+        operation_ptr discarded;
+        operation_ptr high_handler;
+        auto result = admission::queued;
+        {
+            std::unique_lock<std::mutex> lock(m_CS);
+            if (m_operations.size() >= m_capacity) {
+                switch (m_policy) {
+                    case overflow_policy::block:
+                        if (!may_wait) {
+                            if (count_refused) {
+                                ++m_dropped;
+                            }
+                            return admission::rejected;
+                        }
+                        wait_for_space(lock);
+                        break;
+                    case overflow_policy::reject:
+                        if (count_refused) {
+                            ++m_dropped;
+                        }
+                        return admission::rejected;
+                    case overflow_policy::drop_oldest:
+                        discarded = std::move(m_operations.front());
+                        m_operations.pop_front();
+                        ++m_dropped;
+                        result = admission::replaced;
+                        break;
+                    case overflow_policy::drop_newest:
+                        discarded = std::move(m_operations.back());
+                        m_operations.pop_back();
+                        ++m_dropped;
+                        result = admission::replaced;
+                        break;
+                }
+            }
+            m_operations.push_back(op);
+
+            if (m_high > 0 && !m_high_reached &&
+                m_operations.size() >= m_high) {
+                m_high_reached = true;
+                high_handler = m_on_high;
+            }
+        }
+
+        if (high_handler) {
+            execute_operation_on_this_thread(*high_handler);
+        }
+        return result;
+    }
+
+    size_t depth()
+    {
+        std::lock_guard<std::mutex> lock(m_CS);
+        return m_operations.size();
+    }
+
+    size_t dropped()
+    {
+        std::lock_guard<std::mutex> lock(m_CS);
+        return m_dropped;
+    }
+
+    void on_high_watermark(size_t high, const operation_ptr& op)
+    {
+        std::lock_guard<std::mutex> lock(m_CS);
+        m_high = high;
+        m_on_high = op;
+    }
+
+    void on_low_watermark(size_t low, const operation_ptr& op)
+    {
+        std::lock_guard<std::mutex> lock(m_CS);
+        m_low = low;
+        m_on_low = op;
+    }
+
+private:
+    std::mutex m_CS;
+    std::condition_variable m_cond;
+
+    std::list<operation_ptr> m_operations;
+    const size_t m_capacity;
+    const overflow_policy m_policy;
+    size_t m_dropped;
+
+    size_t m_high;
+    size_t m_low;
+    bool m_high_reached;
+    operation_ptr m_on_high;
+    operation_ptr m_on_low;
+
+    void wait_for_space(std::unique_lock<std::mutex>& lock)
+    {
+        XDISPATCH_TRACE() << "Queue full, waiting for space";
+        // allow a naive threadpool to compensate for the blocked thread
+        naive::ithreadpool::block_scope blocked;
+        m_cond.wait(lock,
+                    [this] { return m_operations.size() < m_capacity; });
+    }
+};
+
+class bounded_queue::impl
+  : public std::enable_shared_from_this<bounded_queue::impl>
+  , public iqueue_impl
+{
+public:
+    impl(const queue& inner_queue, size_t capacity, overflow_policy policy)
+      : m_worker(std::make_shared<bounded_queue_operation>(capacity, policy))
+      , m_inner_queue(inner_queue)
+    {}
+
+    size_t depth() { return m_worker->depth(); }
+
+    size_t dropped() { return m_worker->dropped(); }
+
+    void on_high_watermark(size_t high, const operation_ptr& op)
+    {
+        m_worker->on_high_watermark(high, op);
+    }
+
+    void on_low_watermark(size_t low, const operation_ptr& op)
+    {
+        m_worker->on_low_watermark(low, op);
+    }
+
+    void async(const operation_ptr& op) override
+    {
+        // only the inner queue can make room, so an operation executed by
+        // it would wait for itself. Refuse instead of deadlocking
+        const bool may_wait = !m_inner_queue.is_current();
+        if (!submit(op, may_wait, true)) {
+            XDISPATCH_TRACE() << "Queue full, discarding operation";
+        }
+    }
+
+    bool try_async(const operation_ptr& op) override
+    {
+        return submit(op, false, false);
+    }
+
+    void barrier_async(const operation_ptr& op) override
+    {
+        // every operation buffered before the barrier has its drain queued
+        // to the inner queue already, so ordering is preserved
+        m_inner_queue.barrier_async(op);
+    }
+
+    void sync(const operation_ptr& op) override
+    {
+        // the caller is blocked anyways, no need to apply the capacity
+        m_inner_queue.sync(op);
+    }
+
+    void apply(size_t times, const iteration_operation_ptr& op) override
+    {
+        m_inner_queue.apply(times, op);
+    }
+
+    void after(std::chrono::milliseconds delay,
+               const operation_ptr& op) override
+    {
+        auto timer =
+          backend_for_type(backend()).create_timer(shared_from_this());
+        timer->handler(make_operation([op, timer] {
+            execute_operation_on_this_thread(*op);
+            timer->cancel();
+        }));
+        timer->resume(delay);
+    }
+
+    backend_type backend() override
+    {
+        return m_inner_queue.implementation()->backend();
+    }
+
+    queue_priority priority() override
+    {
+        return m_inner_queue.implementation()->priority();
+    }
+
+    void boost(queue_priority priority) override
+    {
+        m_inner_queue.implementation()->boost(priority);
+    }
+
+private:
+    std::shared_ptr<bounded_queue_operation> m_worker;
+    queue m_inner_queue;
+
+    bool submit(const operation_ptr& op, bool may_wait, bool count_refused)
+    {
+        switch (m_worker->add_one(op, may_wait, count_refused)) {
+            case bounded_queue_operation::admission::queued:
+                m_inner_queue.async(m_worker);
+                return true;
+            case bounded_queue_operation::admission::replaced:
+                // the drain queued for the discarded operation
+                // will take care of the new operation instead
+                return true;
+            case bounded_queue_operation::admission::rejected:
+                return false;
+        }
+        return false;
+    }
+};
+
+bounded_queue::bounded_queue(const std::string& label,
+                             size_t capacity,
+                             overflow_policy policy,
+                             queue_priority priority)
+  : bounded_queue(label, queue(label, priority), capacity, policy)
+{}
+
+bounded_queue::bounded_queue(const std::string& label,
+                             const queue& inner_queue,
+                             size_t capacity,
+                             overflow_policy policy)
+  : queue(label, std::make_shared<impl>(inner_queue, capacity, policy))
+{}
+
+size_t
+bounded_queue::depth() const
+{
+    const auto inner = std::static_pointer_cast<impl>(implementation());
+    return inner->depth();
+}
+
+size_t
+bounded_queue::dropped() const
+{
+    const auto inner = std::static_pointer_cast<impl>(implementation());
+    return inner->dropped();
+}
+
+void
+bounded_queue::on_high_watermark(size_t high, const operation_ptr& op)
+{
+    const auto inner = std::static_pointer_cast<impl>(implementation());
+    inner->on_high_watermark(high, op);
+}
+
+void
+bounded_queue::on_low_watermark(size_t low, const operation_ptr& op)
+{
+    const auto inner = std::static_pointer_cast<impl>(implementation());
+    inner->on_low_watermark(low, op);
+}
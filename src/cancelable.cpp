@@ -22,21 +22,20 @@
 #include "xdispatch/impl/cancelable.h"
 #include "xdispatch_internal.h"
 
-#include <cstdlib>
-#include <set>
-
 __XDISPATCH_BEGIN_NAMESPACE
 
-static thread_local std::set<cancelable*> current_c;
-
 cancelable::cancelable()
   : m_active(active_enabled)
+  , m_owner(std::thread::id())
 {}
 
 void
 cancelable::disable()
 {
-    if (current_c.find(this) != current_c.end()) {
+    // only the running thread ever stores its own id, so no other
+    // thread will observe a match here
+    if (m_owner.load(std::memory_order_relaxed) ==
+        std::this_thread::get_id()) {
         // recursion
         m_active.store(active_disabled);
     } else {
@@ -53,7 +52,7 @@ cancelable::enter()
 {
     auto expected = active_enabled;
     if (m_active.compare_exchange_strong(expected, active_running)) {
-        current_c.insert(this);
+        m_owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
         return true;
     }
     // disabled
@@ -63,7 +62,7 @@ cancelable::enter()
 void
 cancelable::leave()
 {
-    current_c.erase(this);
+    m_owner.store(std::thread::id(), std::memory_order_relaxed);
     auto expected = active_running;
     if (!m_active.compare_exchange_strong(expected, active_enabled)) {
         // disabled in the meantime
@@ -0,0 +1,48 @@
+/*
+ * cancellation.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xdispatch_internal.h"
+
+__XDISPATCH_BEGIN_NAMESPACE
+
+cancellation_source::cancellation_source()
+  : m_state(make_ref<cancellation_state>())
+{}
+
+cancellation_token
+cancellation_source::token() const
+{
+    return cancellation_token(m_state);
+}
+
+void
+cancellation_source::cancel() const
+{
+    m_state->m_cancelled.store(true, std::memory_order_release);
+}
+
+bool
+cancellation_source::is_cancelled() const
+{
+    return m_state->m_cancelled.load(std::memory_order_acquire);
+}
+
+__XDISPATCH_END_NAMESPACE
@@ -43,9 +43,47 @@ group::async(const operation_ptr& op, const queue& q) const
     }
 
     queue_operation_with_d(*op, q_impl.get());
+    flush_batch(q_impl.get());
     m_impl->async(op, q_impl);
 }
 
+void
+group::async(const operation_ptr& op,
+             const queue& q,
+             std::chrono::steady_clock::time_point deadline,
+             const operation_ptr& on_expired) const
+{
+    XDISPATCH_ASSERT(op);
+
+    const auto q_impl = q.implementation();
+    if (backend_type::naive != m_impl->backend()) {
+        trace_utils::assert_same_backend(m_impl->backend(), q_impl->backend());
+    }
+
+    queue_operation_with_d(*op, q_impl.get());
+    flush_batch(q_impl.get());
+    m_impl->async(
+      make_deadline_operation(op, deadline, on_expired, q_impl).release(),
+      q_impl);
+}
+
+void
+group::async(const operation_ptr& op,
+             const queue& q,
+             const cancellation_token& token) const
+{
+    XDISPATCH_ASSERT(op);
+
+    const auto q_impl = q.implementation();
+    if (backend_type::naive != m_impl->backend()) {
+        trace_utils::assert_same_backend(m_impl->backend(), q_impl->backend());
+    }
+
+    queue_operation_with_d(*op, q_impl.get());
+    flush_batch(q_impl.get());
+    m_impl->async(make_cancellable_operation(op, token), q_impl);
+}
+
 void
 group::async(const operation_ptr& op, queue_priority priority) const
 {
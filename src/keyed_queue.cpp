@@ -0,0 +1,79 @@
+/*
+ * keyed_queue.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+
+#include "xdispatch_internal.h"
+#include "xdispatch/keyed_queue.h"
+
+__XDISPATCH_USE_NAMESPACE
+
+static std::vector<queue>
+create_lanes(const std::string& label,
+             size_t lane_count,
+             queue_priority priority)
+{
+    std::vector<queue> lanes;
+    lanes.reserve(lane_count);
+    for (size_t i = 0; i < lane_count; ++i) {
+        lanes.emplace_back(label + "." + std::to_string(i), priority);
+    }
+    return lanes;
+}
+
+keyed_queue::keyed_queue(const std::string& label,
+                         size_t lane_count,
+                         queue_priority priority)
+  : keyed_queue(label, create_lanes(label, lane_count, priority))
+{}
+
+keyed_queue::keyed_queue(const std::string& label,
+                         const std::vector<queue>& lanes)
+  : m_lanes(lanes)
+  , m_label(label)
+{
+    XDISPATCH_ASSERT(!m_lanes.empty());
+}
+
+const queue&
+keyed_queue::lane_for_hash(size_t hash) const
+{
+    // common std::hash implementations map integers onto themselves,
+    // scramble the bits so that keys with a common stride still get
+    // distributed evenly on all lanes
+    std::uint64_t mixed = hash;
+    mixed ^= mixed >> 33;
+    mixed *= 0xff51afd7ed558ccdULL;
+    mixed ^= mixed >> 33;
+    return m_lanes[mixed % m_lanes.size()];
+}
+
+size_t
+keyed_queue::lane_count() const
+{
+    return m_lanes.size();
+}
+
+std::string
+keyed_queue::label() const
+{
+    return m_label;
+}
@@ -31,9 +31,11 @@ namespace libdispatch {
 class queue_impl : public iqueue_impl
 {
 public:
-    queue_impl(dispatch_queue_t native)
+    queue_impl(dispatch_queue_t native,
+               queue_priority priority = queue_priority::DEFAULT)
       : iqueue_impl()
       , m_native(native)
+      , m_priority(priority)
     {
         XDISPATCH_ASSERT(m_native);
         dispatch_retain(m_native);
@@ -52,6 +54,21 @@ public:
           m_native, wrapper.release(), _xdispatch2_run_wrap_delete);
     }
 
+    void barrier_async(const operation_ptr& op) final
+    {
+        // note: libdispatch will treat barriers on the global
+        //       queues like any other async operation
+        auto wrapper = std::make_unique<operation_wrap>(op);
+        dispatch_barrier_async_f(
+          m_native, wrapper.release(), _xdispatch2_run_wrap_delete);
+    }
+
+    void sync(const operation_ptr& op) final
+    {
+        operation_wrap wrap(op);
+        dispatch_sync_f(m_native, &wrap, _xdispatch2_run_wrap);
+    }
+
     void apply(size_t times, const iteration_operation_ptr& op) final
     {
         iteration_operation_wrap wrap(op);
@@ -70,10 +87,13 @@ public:
 
     backend_type backend() final { return backend_type::libdispatch; }
 
+    queue_priority priority() final { return m_priority; }
+
     friend dispatch_queue_t impl_2_native(const iqueue_impl_ptr& impl);
 
 private:
     dispatch_queue_t m_native;
+    const queue_priority m_priority;
 };
 
 dispatch_queue_t
@@ -104,6 +124,7 @@ priority_2_native(queue_priority priority)
             native = DISPATCH_QUEUE_PRIORITY_DEFAULT;
             break;
         case queue_priority::BACKGROUND:
+        case queue_priority::IDLE:
             native = DISPATCH_QUEUE_PRIORITY_BACKGROUND;
             break;
     }
@@ -123,7 +144,8 @@ iqueue_impl_ptr
 backend::create_main_queue(const std::string& /* label */
 )
 {
-    return std::make_shared<queue_impl>(dispatch_get_main_queue());
+    return std::make_shared<queue_impl>(dispatch_get_main_queue(),
+                                        queue_priority::USER_INTERACTIVE);
 }
 
 iqueue_impl_ptr
@@ -133,7 +155,7 @@ backend::create_serial_queue(const std::string& label, queue_priority priority)
       DISPATCH_QUEUE_SERIAL, priority_2_native(priority), 0);
     object_scope_T<dispatch_queue_t> native(
       dispatch_queue_create(label.c_str(), qos_attr));
-    return std::make_shared<queue_impl>(native.take());
+    return std::make_shared<queue_impl>(native.take(), priority);
 }
 
 iqueue_impl_ptr
@@ -141,7 +163,8 @@ backend::create_parallel_queue(const std::string& /* label */,
                                queue_priority priority)
 {
     const auto qos = priority_2_native(priority);
-    return std::make_shared<queue_impl>(dispatch_get_global_queue(qos, 0));
+    return std::make_shared<queue_impl>(dispatch_get_global_queue(qos, 0),
+                                        priority);
 }
 
 } // namespace libdispatch
@@ -20,138 +20,231 @@
  */
 
 #include "xdispatch/impl/lightweight_barrier.h"
+#include "xdispatch/backend_naive_ithreadpool.h"
 #include "xdispatch_internal.h"
+#include "thread_utils.h"
 
-#include <cstdlib>
-#include <mutex>
-#include <condition_variable>
+#include <algorithm>
+#include <climits>
 
-__XDISPATCH_BEGIN_NAMESPACE
+#if (defined XDISPATCH2_HAVE_FUTEX)
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#else
+    #include <condition_variable>
+    #include <mutex>
+#endif
 
-// Indicates the barrier has nobody waiting and has not been completed
-static constexpr lightweight_barrier::waiter* kNoOwner{ nullptr };
+__XDISPATCH_BEGIN_NAMESPACE
 
+// Indicates the barrier has not been completed and nobody is parked on it
+static constexpr std::uint32_t kPending = 0;
+// Indicates the barrier has not been completed and threads may be parked
+static constexpr std::uint32_t kWaiting = 1;
 // Indicates the barrier has been completed
-static char kInvalidAddressUsedForCompleted = 0;
-static lightweight_barrier::waiter* const kCompleted{
-    reinterpret_cast<lightweight_barrier::waiter*>(
-      &kInvalidAddressUsedForCompleted)
-};
+static constexpr std::uint32_t kCompleted = 2;
 
-class lightweight_barrier::waiter
-{
-public:
-    waiter()
-      : m_done(false)
-    {}
+// Number of times to check for completion before parking the thread
+static constexpr int kSpinCount = 64;
 
-    inline bool wait(
-      std::chrono::milliseconds timeout = std::chrono::milliseconds(-1))
-    {
-        auto predicate = [this] { return m_done; };
+#if (defined XDISPATCH2_HAVE_FUTEX)
 
-        std::unique_lock<std::mutex> lock(m_mutex);
-        if (!predicate()) {
-            if (std::chrono::milliseconds(-1) != timeout) {
-                return m_cond.wait_for(lock, timeout, predicate);
-            }
-            m_cond.wait(lock, predicate);
-            return true;
-        }
-        return true;
-    }
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+              "futex needs to operate on the value directly");
 
-    inline void complete()
-    {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_done = true;
-        m_cond.notify_all();
-    }
+// blocks as long as the value at address equals expected
+static void
+futex_wait(std::atomic<std::uint32_t>& value,
+           std::uint32_t expected,
+           const timespec* timeout)
+{
+    syscall(SYS_futex,
+            reinterpret_cast<std::uint32_t*>(&value),
+            FUTEX_WAIT_PRIVATE,
+            expected,
+            timeout,
+            nullptr,
+            0);
+}
 
-    inline bool was_completed()
-    {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        return m_done;
-    }
+// wakes all threads blocked on the given address. This does not access
+// the value itself, so the barrier may have been destroyed already
+static void
+futex_wake_all(std::atomic<std::uint32_t>& value)
+{
+    syscall(SYS_futex,
+            reinterpret_cast<std::uint32_t*>(&value),
+            FUTEX_WAKE_PRIVATE,
+            INT_MAX,
+            nullptr,
+            nullptr,
+            0);
+}
+
+#else
 
-private:
-    bool m_done;
-    std::mutex m_mutex;
+// Threads are parked on a fixed set of condition variables shared by
+// all barriers, selected by the address of the barrier. Waking a slot
+// never accesses the barrier itself, so the barrier may have been
+// destroyed already
+struct parking_slot
+{
+    std::mutex m_CS;
     std::condition_variable m_cond;
 };
 
-lightweight_barrier::lightweight_barrier()
-  : m_owner{ kNoOwner }
-{}
+static constexpr size_t kParkingSlots = 64;
 
-lightweight_barrier::~lightweight_barrier()
+static parking_slot&
+parking_slot_for(const void* address)
 {
-    auto* owner = m_owner.load(std::memory_order_acquire);
-    if (owner && owner != kCompleted) {
-        delete owner;
-    }
+    // intentionally leaked to remain usable during static destruction
+    static auto* const s_slots = new parking_slot[kParkingSlots];
+    const auto hash = reinterpret_cast<std::uintptr_t>(address) >> 4;
+    return s_slots[hash % kParkingSlots];
 }
 
+#endif
+
+lightweight_barrier::lightweight_barrier()
+  : m_state{ kPending }
+{}
+
 bool
 lightweight_barrier::wait(std::chrono::milliseconds timeout)
 {
-    // avoid allocating a waiter object unecessarily
-    // by checking the atomic value first to see if we
-    // can bail out quickly
-    waiter* previous = m_owner.load(std::memory_order_acquire);
-    if (kCompleted == previous) {
+    if (was_completed()) {
+        return true;
+    }
+    if (std::chrono::milliseconds(0) == timeout) {
+        return false;
+    }
+
+    // completion is often only a few instructions away
+    for (int i = 0; i < kSpinCount; ++i) {
+        thread_utils::cpu_relax();
+        if (was_completed()) {
+            return true;
+        }
+    }
+
+    // announce that a thread is about to park so that complete()
+    // knows it needs to wake it up
+    auto state = kPending;
+    if (!m_state.compare_exchange_strong(
+          state, kWaiting, std::memory_order_acq_rel) &&
+        kCompleted == state) {
         return true;
     }
+    return park(timeout);
+}
 
-    // try to become the owner of the mutex
-    auto candidate = std::make_unique<waiter>();
-    previous = kNoOwner;
-    if (m_owner.compare_exchange_weak(
-          previous, candidate.get(), std::memory_order_acq_rel)) {
-        // value was incomplete before, we are the owner now so wait
-        auto* barrier = candidate.release();
-        return barrier->wait(timeout);
+bool
+lightweight_barrier::park(std::chrono::milliseconds timeout)
+{
+    using clock = std::chrono::steady_clock;
+
+    const bool forever = std::chrono::milliseconds(-1) == timeout ||
+                         std::chrono::milliseconds::max() == timeout;
+    const auto deadline =
+      forever ? clock::time_point::max() : clock::now() + timeout;
+
+#if (defined XDISPATCH2_HAVE_FUTEX)
+    while (!was_completed()) {
+        if (forever) {
+            futex_wait(m_state, kWaiting, nullptr);
+            continue;
+        }
+
+        const auto remaining = deadline - clock::now();
+        if (remaining <= clock::duration::zero()) {
+            return false;
+        }
+        const auto seconds =
+          std::chrono::duration_cast<std::chrono::seconds>(remaining);
+        timespec relative;
+        relative.tv_sec = static_cast<time_t>(seconds.count());
+        relative.tv_nsec = static_cast<long>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(remaining -
+                                                               seconds)
+            .count());
+        futex_wait(m_state, kWaiting, &relative);
     }
-    if (kCompleted == previous) {
-        // value was (and still is) complete, so no need to block
+    return true;
+
+#else
+    auto& slot = parking_slot_for(&m_state);
+    const auto predicate = [this] { return was_completed(); };
+
+    std::unique_lock<std::mutex> lock(slot.m_CS);
+    if (forever) {
+        slot.m_cond.wait(lock, predicate);
         return true;
     }
-    // else: somebody else placed a waiter barrier before, use it instead
-    // (previous holds the barrier obtained from compare_exchange_weak above)
-    return previous->wait(timeout);
+    return slot.m_cond.wait_until(lock, deadline, predicate);
+
+#endif
 }
 
 void
 lightweight_barrier::complete()
 {
-    // NOLINTBEGIN(bugprone-branch-clone)
-    // branches are kept for readability
-
-    auto* previous = kNoOwner;
-    if (m_owner.compare_exchange_weak(
-          previous, kCompleted, std::memory_order_acq_rel)) { // NOLINT
-        // nobody was waiting and now marked as complete
-    } else if (kCompleted == previous) { // NOLINT
-        // complete before
-    } else if (kNoOwner != previous) { // NOLINT
-        // somebody is waiting
-        previous->complete();
+    if (kWaiting != m_state.exchange(kCompleted, std::memory_order_acq_rel)) {
+        // nobody is parked
+        return;
+    }
+
+#if (defined XDISPATCH2_HAVE_FUTEX)
+    futex_wake_all(m_state);
+
+#else
+    auto& slot = parking_slot_for(&m_state);
+    {
+        // a waiter either observed the completion while holding the
+        // lock or is waiting on the condition already
+        std::lock_guard<std::mutex> lock(slot.m_CS);
     }
+    slot.m_cond.notify_all();
 
-    // NOLINTEND(bugprone-branch-clone)
+#endif
 }
 
 bool
 lightweight_barrier::was_completed() const
 {
-    waiter* previous = m_owner.load(std::memory_order_acquire);
-    if (kCompleted == previous) {
-        return true;
-    }
-    if (kNoOwner != previous) {
-        return previous->was_completed();
+    return kCompleted == m_state.load(std::memory_order_acquire);
+}
+
+bool
+wait_helping(lightweight_barrier& barrier, std::chrono::milliseconds timeout)
+{
+    using clock = std::chrono::steady_clock;
+    using naive::ithreadpool;
+
+    if (ithreadpool::current() && std::chrono::milliseconds(0) != timeout) {
+        const bool forever = std::chrono::milliseconds(-1) == timeout ||
+                             std::chrono::milliseconds::max() == timeout;
+        const auto deadline = forever ? clock::time_point::max()
+                                      : clock::now() + timeout;
+        while (!barrier.was_completed()) {
+            if (clock::now() >= deadline || !ithreadpool::help_current()) {
+                break;
+            }
+        }
+        if (barrier.was_completed()) {
+            return true;
+        }
+        if (!forever) {
+            timeout = std::max(
+              std::chrono::milliseconds(0),
+              std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - clock::now()));
+        }
     }
-    return false;
+
+    ithreadpool::block_scope blocked;
+    return barrier.wait(timeout);
 }
 
 __XDISPATCH_END_NAMESPACE
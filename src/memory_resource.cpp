@@ -0,0 +1,87 @@
+/*
+ * memory_resource.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "xdispatch/memory_resource.h"
+#include "xdispatch_internal.h"
+
+#include <atomic>
+#include <cstdint>
+
+__XDISPATCH_USE_NAMESPACE
+
+namespace {
+
+class new_delete_memory_resource : public memory_resource
+{
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) final
+    {
+        if (alignment <= alignof(std::max_align_t)) {
+            return ::operator new(bytes);
+        }
+
+        // over-allocate and remember the original address in front of
+        // the block handed out
+        void* const raw = ::operator new(bytes + alignment + sizeof(void*));
+        auto address = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+        address = (address + alignment - 1) & ~(alignment - 1);
+        auto* const aligned = reinterpret_cast<void*>(address);
+        static_cast<void**>(aligned)[-1] = raw;
+        return aligned;
+    }
+
+    void do_deallocate(void* ptr, size_t /* bytes */, size_t alignment) final
+    {
+        if (alignment <= alignof(std::max_align_t)) {
+            ::operator delete(ptr);
+            return;
+        }
+        ::operator delete(static_cast<void**>(ptr)[-1]);
+    }
+};
+
+std::atomic<memory_resource*> s_default_resource(nullptr);
+
+} // namespace
+
+memory_resource*
+xdispatch::new_delete_resource() noexcept
+{
+    // never destroyed so that it can be used during exit
+    static auto* const s_resource = new new_delete_memory_resource();
+    return s_resource;
+}
+
+memory_resource*
+xdispatch::get_default_resource() noexcept
+{
+    auto* const resource = s_default_resource.load(std::memory_order_acquire);
+    return resource ? resource : new_delete_resource();
+}
+
+memory_resource*
+xdispatch::set_default_resource(memory_resource* resource) noexcept
+{
+    auto* const previous =
+      s_default_resource.exchange(resource, std::memory_order_acq_rel);
+    return previous ? previous : new_delete_resource();
+}
@@ -71,6 +71,22 @@ public:
         return create_parallel_queue(label, priority, backend_type::naive);
     }
 
+    /**
+       @brief Creates a parallel queue executing at most max_width
+              operations at the same time
+
+       @see naive::create_concurrent_queue
+     */
+    iqueue_impl_ptr create_concurrent_queue(
+      const std::string& label,
+      size_t max_width,
+      queue_priority priority,
+      memory_resource* resource = nullptr)
+    {
+        return create_concurrent_queue(
+          label, max_width, priority, backend_type::naive, resource);
+    }
+
     /**
        @copydoc ibackend::create_group
      */
@@ -122,6 +138,12 @@ protected:
                                           queue_priority priority,
                                           backend_type backend);
 
+    iqueue_impl_ptr create_concurrent_queue(const std::string& label,
+                                            size_t max_width,
+                                            queue_priority priority,
+                                            backend_type backend,
+                                            memory_resource* resource);
+
     igroup_impl_ptr create_group(backend_type backend);
 
     itimer_impl_ptr create_timer(const iqueue_impl_ptr& queue,
@@ -143,13 +165,23 @@ XDISPATCH_EXPORT queue
 create_serial_queue(const std::string& label,
                     const ithreadpool_ptr& threadpool,
                     queue_priority priority,
-                    backend_type backend);
+                    backend_type backend,
+                    memory_resource* resource = nullptr);
 
 XDISPATCH_EXPORT queue
 create_parallel_queue(const std::string& label,
                       const ithreadpool_ptr& pool,
                       queue_priority priority,
-                      backend_type backend);
+                      backend_type backend,
+                      memory_resource* resource = nullptr);
+
+XDISPATCH_EXPORT queue
+create_concurrent_queue(const std::string& label,
+                        size_t max_width,
+                        const ithreadpool_ptr& pool,
+                        queue_priority priority,
+                        backend_type backend,
+                        memory_resource* resource = nullptr);
 
 } // namespace naive
 __XDISPATCH_END_NAMESPACE
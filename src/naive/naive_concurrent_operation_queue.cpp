@@ -0,0 +1,226 @@
+/*
+ * naive_concurrent_operation_queue.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "naive_concurrent_operation_queue.h"
+
+#include "../thread_utils.h"
+
+__XDISPATCH_BEGIN_NAMESPACE
+namespace naive {
+
+constexpr size_t concurrent_operation_queue::unlimited_width;
+
+concurrent_operation_queue::concurrent_operation_queue(
+  const ithreadpool_ptr& threadpool,
+  queue_priority priority,
+  memory_resource* resource,
+  size_t max_width)
+  : m_priority(priority)
+  , m_threadpool(threadpool)
+  , m_resource(resource)
+  , m_max_width(max_width)
+  , m_jobs()
+  , m_buffered(0)
+  , m_inflight(0)
+  , m_pending(0)
+  , m_barrier_pending(false)
+  , m_CS()
+  , m_deferred(polymorphic_allocator<deferred_job>(resource))
+  , m_barrier_running(false)
+  , m_drain_operation(this, &concurrent_operation_queue::drain)
+{
+    XDISPATCH_ASSERT(m_threadpool);
+    XDISPATCH_ASSERT(m_resource);
+    XDISPATCH_ASSERT(m_max_width > 0);
+}
+
+void
+concurrent_operation_queue::async(const operation_ptr& job)
+{
+    async(inline_operation(job));
+}
+
+void
+concurrent_operation_queue::async(inline_operation&& job)
+{
+    inline_operation job2(std::move(job));
+
+    // count the job as pending before testing for a barrier so that a
+    // barrier queued at the same time will either wait for this job
+    // or this job will observe the barrier and be held back
+    m_pending.fetch_add(1);
+    if (!m_barrier_pending.load()) {
+        admit(std::move(job2));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_CS);
+        if (!m_barrier_pending.load()) {
+            // all barriers completed in the meantime
+            admit(std::move(job2));
+            return;
+        }
+        m_deferred.push_back({ std::move(job2), false });
+    }
+    // the job got deferred, revert counting it as pending
+    complete_one();
+}
+
+void
+concurrent_operation_queue::barrier_async(const operation_ptr& job)
+{
+    std::lock_guard<std::mutex> lock(m_CS);
+    m_deferred.push_back({ inline_operation(job), true });
+    m_barrier_pending.store(true);
+    process_deferred_unsafe();
+}
+
+void
+concurrent_operation_queue::admit(inline_operation&& job)
+{
+    m_jobs.enqueue(std::move(job));
+    m_buffered.fetch_add(1);
+    if (try_acquire_slot()) {
+        // the drain request shares ownership with this queue
+        // so that we stay alive until all jobs have been run. Like
+        // the follow-up drains and barriers it is boosted to the
+        // priority of the queue submitting to us
+        m_threadpool->execute(
+          operation_ptr(shared_from_this(), &m_drain_operation),
+          inherit_priority(m_priority));
+    }
+}
+
+bool
+concurrent_operation_queue::try_acquire_slot()
+{
+    size_t inflight = m_inflight.load();
+    while (inflight < m_max_width) {
+        if (m_inflight.compare_exchange_weak(inflight, inflight + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+concurrent_operation_queue::try_acquire_job()
+{
+    size_t buffered = m_buffered.load();
+    while (buffered > 0) {
+        if (m_buffered.compare_exchange_weak(buffered, buffered - 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+concurrent_operation_queue::drain()
+{
+    if (try_acquire_job()) {
+        // every buffered job was enqueued before being counted, so a
+        // job is guaranteed to be available even if dequeuing from
+        // the lock-free queue fails spontaneously
+        inline_operation job;
+        while (!m_jobs.try_dequeue(job)) {
+            thread_utils::cpu_relax();
+        }
+        execute(job);
+        job.reset();
+
+        complete_one();
+    }
+
+    m_inflight.fetch_sub(1);
+    // without a width limit every admitted job brings its own drain
+    // request, otherwise jobs may have been admitted while all slots
+    // were taken and we need to pick them up on their behalf
+    if (m_max_width != unlimited_width && m_buffered.load() > 0 &&
+        try_acquire_slot()) {
+        m_threadpool->execute(
+          operation_ptr(shared_from_this(), &m_drain_operation),
+          inherit_priority(m_priority));
+    }
+}
+
+void
+concurrent_operation_queue::execute(inline_operation& job)
+{
+    execute_operation_on_this_thread(job);
+}
+
+void
+concurrent_operation_queue::complete_one()
+{
+    if (1 == m_pending.fetch_sub(1) && m_barrier_pending.load()) {
+        // the last pending job completed, a barrier may run now
+        std::lock_guard<std::mutex> lock(m_CS);
+        process_deferred_unsafe();
+    }
+}
+
+void
+concurrent_operation_queue::complete_barrier()
+{
+    std::lock_guard<std::mutex> lock(m_CS);
+    m_barrier_running = false;
+    process_deferred_unsafe();
+}
+
+void
+concurrent_operation_queue::process_deferred_unsafe()
+{
+    while (!m_barrier_running && !m_deferred.empty()) {
+        auto& front = m_deferred.front();
+        if (front.m_barrier) {
+            if (0 != m_pending.load()) {
+                // completion of the last pending job will resume
+                return;
+            }
+
+            m_barrier_running = true;
+            const auto this_ptr = shared_from_this();
+            const auto barrier = make_recycled<inline_operation>(
+              m_resource, std::move(front.m_job));
+            m_deferred.pop_front();
+            m_threadpool->execute(make_operation([this_ptr, barrier] {
+                                      this_ptr->execute(*barrier);
+                                      this_ptr->complete_barrier();
+                                  }),
+                                  inherit_priority(m_priority));
+            return;
+        }
+
+        m_pending.fetch_add(1);
+        admit(std::move(front.m_job));
+        m_deferred.pop_front();
+    }
+
+    if (!m_barrier_running) {
+        // all barriers passed, resume using the fast path
+        m_barrier_pending.store(false);
+    }
+}
+
+} // namespace naive
+__XDISPATCH_END_NAMESPACE
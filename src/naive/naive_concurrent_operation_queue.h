@@ -0,0 +1,159 @@
+/*
+ * naive_concurrent_operation_queue.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XDISPATCH_NAIVE_CONCURRENT_OPERATION_QUEUE_H_
+#define XDISPATCH_NAIVE_CONCURRENT_OPERATION_QUEUE_H_
+
+#include <limits>
+#include <list>
+#include <mutex>
+
+#include "naive_backend_internal.h"
+#include "naive_concurrentqueue.h"
+
+__XDISPATCH_BEGIN_NAMESPACE
+namespace naive {
+
+/**
+    A threadsafe queue which will execute operations concurrently
+
+    Operations are buffered in a lock-free queue and for each operation
+    a drain request is passed to the threadpool. Whenever the threadpool
+    executes such a request, the next operation in the buffer is run.
+
+    While no barrier is active, operations pass through the lock-free
+    fast path only. Once a barrier gets queued, all operations queued
+    afterwards are held back until all operations queued before the
+    barrier and the barrier itself have completed.
+
+    The number of drain requests in flight on the threadpool can be
+    limited to a maximum width. Operations exceeding the width remain
+    in the buffer and are picked up by the next drain request that
+    becomes available, i.e. no thread of the pool will ever block
+    waiting for a free slot.
+
+    The queue is kept alive by every drain request passed to the
+    threadpool so that it is safe to release the owning reference
+    while operations are still pending.
+ */
+class concurrent_operation_queue
+  : public std::enable_shared_from_this<concurrent_operation_queue>
+{
+public:
+    /**
+        @brief Denotes a queue without any limit on its width
+     */
+    static constexpr size_t unlimited_width =
+      std::numeric_limits<size_t>::max();
+
+    /**
+        @param threadpool The threadpool implementation that all queued
+       operations will be eventually executed on
+        @param priority The priority at which the queue operates
+        @param resource The memory_resource to allocate from
+        @param max_width The maximum number of operations to execute
+       concurrently
+     */
+    concurrent_operation_queue(const ithreadpool_ptr& threadpool,
+                               queue_priority priority,
+                               memory_resource* resource,
+                               size_t max_width = unlimited_width);
+
+    virtual ~concurrent_operation_queue() = default;
+
+    /**
+        @brief Enqueues the passed job for concurrent execution
+     */
+    void async(const operation_ptr& job);
+
+    /**
+        @brief Enqueues the passed job for concurrent execution
+     */
+    void async(inline_operation&& job);
+
+    /**
+        @brief Enqueues the passed job as a barrier
+
+        The job will run once all jobs queued before have completed and
+        no other job will be started until the barrier has completed.
+     */
+    void barrier_async(const operation_ptr& job);
+
+    /**
+        @returns The priority at which the queue operates
+     */
+    queue_priority priority() const { return m_priority; }
+
+    /**
+        @returns The memory_resource the queue allocates from
+     */
+    memory_resource* resource() const { return m_resource; }
+
+protected:
+    /**
+        @brief Executes a single job, invoked on the thread running it
+     */
+    virtual void execute(inline_operation& job);
+
+private:
+    struct deferred_job
+    {
+        inline_operation m_job;
+        bool m_barrier;
+    };
+
+    const queue_priority m_priority;
+    const ithreadpool_ptr m_threadpool;
+    memory_resource* const m_resource;
+    const size_t m_max_width;
+    // jobs which have been admitted for execution
+    concurrentqueue<inline_operation> m_jobs;
+    // number of admitted jobs not picked up by a drain request yet
+    std::atomic<size_t> m_buffered;
+    // number of drain requests passed to the threadpool
+    std::atomic<size_t> m_inflight;
+    // number of admitted jobs not completed yet
+    std::atomic<size_t> m_pending;
+    // set as long as a barrier is queued or running
+    std::atomic<bool> m_barrier_pending;
+    std::mutex m_CS;
+    // jobs held back by a barrier, protected by m_CS
+    std::list<deferred_job, polymorphic_allocator<deferred_job>> m_deferred;
+    // set while a barrier is executing, protected by m_CS
+    bool m_barrier_running;
+    member_operation<concurrent_operation_queue> m_drain_operation;
+
+    void drain();
+    void admit(inline_operation&& job);
+    bool try_acquire_slot();
+    bool try_acquire_job();
+    void complete_one();
+    void complete_barrier();
+    void process_deferred_unsafe();
+};
+
+using concurrent_operation_queue_ptr =
+  std::shared_ptr<concurrent_operation_queue>;
+
+} // namespace naive
+__XDISPATCH_END_NAMESPACE
+
+#endif // XDISPATCH_NAIVE_CONCURRENT_OPERATION_QUEUE_H_
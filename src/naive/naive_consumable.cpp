@@ -69,9 +69,7 @@ consumable::wait_for_consumed(const std::chrono::milliseconds timeout) // NOLINT
     if (0 == m_resources.load()) {
         return true;
     }
-    ithreadpool::block_scope blocked;
-    const auto ret = m_barrier.wait(timeout);
-    return ret;
+    return wait_helping(m_barrier, timeout);
 }
 
 } // namespace naive
@@ -19,91 +19,283 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 #include "xdispatch/impl/igroup_impl.h"
 #include "xdispatch/impl/iqueue_impl.h"
 
 #include "naive_backend_internal.h"
 #include "naive_consumable.h"
-#include "naive_operations.h"
-#include "naive_threadpool.h"
 
 __XDISPATCH_BEGIN_NAMESPACE
 namespace naive {
 
+/**
+    A group tracking its operations using a single counter
+
+    Every time the counter drops to zero the group drained and all
+    waiters registered so far are released at once. The counter is
+    tested again once the list of waiters is locked, so a completion
+    racing with operations queued afterwards will not release waiters
+    of these. Waiters are kept in an intrusive list, threads waiting on
+    the group link an entry living on their own stack.
+
+    While operations are pending, the group keeps itself alive so that
+    operations may complete after all references to it were released.
+ */
 class group_impl
   : public igroup_impl
   , public std::enable_shared_from_this<group_impl>
 {
 public:
-    group_impl(const ithreadpool_ptr& pool, backend_type backend)
+    explicit group_impl(backend_type backend)
       : igroup_impl()
-      , m_pool(pool)
       , m_backend(backend)
-      , m_consumable(std::make_shared<consumable>())
+      , m_pending(0)
+      , m_CS()
+      , m_waiters(nullptr)
+      , m_self()
+      , m_last_queue(nullptr)
+      , m_queues()
     {}
 
-    ~group_impl() override = default;
+    ~group_impl() override
+    {
+        XDISPATCH_ASSERT(nullptr == m_waiters);
+    }
 
     void async(const operation_ptr& op, const iqueue_impl_ptr& q) final
     {
-        const auto c = std::atomic_load(&m_consumable);
-        XDISPATCH_ASSERT(c);
-        c->add_resource();
-        q->async(std::make_shared<consuming_operation>(op, c));
+        if (0 == m_pending.fetch_add(1)) {
+            // first operation since the group drained, it needs to stay
+            // alive until it drained again
+            std::lock_guard<std::mutex> lock(m_CS);
+            if (!m_self) {
+                m_self = shared_from_this();
+            }
+        }
+        // stored inline by naive queues, no allocation needed
+        q->async_inline(inline_operation::make([this, op] {
+            execute_operation_on_this_thread(*op);
+            complete_one();
+        }));
+        remember_queue(q);
     }
 
     bool wait(std::chrono::milliseconds timeout) final
     {
-        // swap the previous consumable with a new one that all operations
-        // submitted after this call will be added to and which waits on the
-        // previous consumable in a chain. Use a compare/exchange and retry
-        // whenever the consumable was already swapped by another thread
-        consumable_ptr old_c;
-        consumable_ptr new_c;
-        do {
-            old_c = std::atomic_load(&m_consumable);
-            new_c = std::make_shared<consumable>(0, old_c);
-        } while (
-          !std::atomic_compare_exchange_weak(&m_consumable, &old_c, new_c));
-        XDISPATCH_ASSERT(old_c);
-        XDISPATCH_ASSERT(new_c);
-        return old_c->wait_for_consumed(timeout);
-
-        // FIXME(zwicker): This is blocking and will not work if invoked from
-        // within
-        //                 an operation active on the same queue as one of the
-        //                 operations listed in the consumable
+        return wait(timeout, inherit_priority(queue_priority::DEFAULT));
+    }
+
+    bool wait(std::chrono::milliseconds timeout, queue_priority priority)
+    {
+        if (0 == m_pending.load()) {
+            return true;
+        }
+
+        blocking_waiter waiter;
+        if (!enlist(waiter)) {
+            // drained meanwhile
+            return true;
+        }
+        boost_queues(priority);
+        // waiting on a pool thread executes other pending operations
+        // meanwhile but will still block if invoked from within an
+        // operation active on the same serial queue as one of the
+        // operations of this group
+        if (wait_helping(waiter.m_barrier, timeout)) {
+            return true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_CS);
+            if (delist(waiter)) {
+                return false;
+            }
+        }
+        // released concurrently, the entry may only go out of
+        // scope once the release completed
+        waiter.m_barrier.wait();
+        return true;
     }
 
     void notify(const operation_ptr& op, const iqueue_impl_ptr& q) final
     {
         XDISPATCH_ASSERT(q);
 
-        const auto this_ptr = shared_from_this();
-        auto notify_op = make_operation([op, q, this_ptr] {
-            // note: wait(..) will already notify the threadpool that
-            //       we are blocking one of its threads through our internal
-            //       use of a consumable
-            this_ptr->wait(std::chrono::milliseconds::max());
-            q->async(op);
-        });
-
-        // FIXME(zwicker): Add accessors to execute with the queue's priority
-        m_pool->execute(notify_op, queue_priority::DEFAULT);
+        // no thread is blocked for waiting, the operation is queued
+        // as soon as the group drained
+        std::unique_ptr<notify_waiter> waiter(new notify_waiter(op, q));
+        if (0 != m_pending.load() && enlist(*waiter)) {
+            waiter.release();
+            boost_queues(q->priority());
+            return;
+        }
+        q->async(op);
     }
 
     backend_type backend() final { return m_backend; }
 
 private:
-    const ithreadpool_ptr m_pool;
+    // an entry in the list of waiters
+    class waiter
+    {
+    public:
+        waiter* m_next = nullptr;
+
+        // invoked once the group drained
+        virtual void release() = 0;
+
+    protected:
+        ~waiter() = default;
+    };
+
+    class blocking_waiter final : public waiter
+    {
+    public:
+        lightweight_barrier m_barrier;
+
+        void release() final { m_barrier.complete(); }
+    };
+
+    class notify_waiter final : public waiter
+    {
+    public:
+        notify_waiter(const operation_ptr& op, const iqueue_impl_ptr& q)
+          : m_op(op)
+          , m_queue(q)
+        {}
+
+        void release() final
+        {
+            m_queue->async(m_op);
+            delete this;
+        }
+
+    private:
+        const operation_ptr m_op;
+        const iqueue_impl_ptr m_queue;
+    };
+
     const backend_type m_backend;
-    consumable_ptr m_consumable;
+    // number of operations queued but not completed yet
+    std::atomic<size_t> m_pending;
+    std::mutex m_CS;
+    // waiters released once the group drained, protected by m_CS
+    waiter* m_waiters;
+    // reference to this while operations are pending, protected by m_CS
+    std::shared_ptr<group_impl> m_self;
+    // the queue remembered last, used to skip the lock when
+    // operations are repeatedly queued to the same queue
+    std::atomic<const iqueue_impl*> m_last_queue;
+    // the queues operations of this group were queued to,
+    // protected by m_CS
+    std::vector<std::weak_ptr<iqueue_impl>> m_queues;
+
+    void complete_one()
+    {
+        if (1 != m_pending.fetch_sub(1)) {
+            return;
+        }
+
+        // the group drained, release all waiters
+        waiter* waiters = nullptr;
+        std::shared_ptr<group_impl> self;
+        {
+            std::lock_guard<std::mutex> lock(m_CS);
+            if (0 != m_pending.load()) {
+                // an operation was queued since, waiters registered
+                // meanwhile wait for it and all others are released
+                // once it completed as well
+                return;
+            }
+            std::swap(waiters, m_waiters);
+            std::swap(self, m_self);
+        }
+        while (waiters) {
+            auto* const next = waiters->m_next;
+            waiters->release();
+            waiters = next;
+        }
+        // self may release the last reference, do not access any
+        // member beyond this point
+    }
+
+    // @returns false if the group drained and the waiter was not added
+    bool enlist(waiter& w)
+    {
+        std::lock_guard<std::mutex> lock(m_CS);
+        if (0 == m_pending.load()) {
+            return false;
+        }
+        w.m_next = m_waiters;
+        m_waiters = &w;
+        return true;
+    }
+
+    // @returns false if the waiter was released already
+    bool delist(waiter& w)
+    {
+        for (auto** it = &m_waiters; *it; it = &(*it)->m_next) {
+            if (*it == &w) {
+                *it = w.m_next;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void remember_queue(const iqueue_impl_ptr& q)
+    {
+        if (q.get() == m_last_queue.load()) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_CS);
+        m_last_queue = q.get();
+        for (const auto& known : m_queues) {
+            if (known.lock() == q) {
+                return;
+            }
+        }
+        // forget about queues which have been released meanwhile
+        m_queues.erase(
+          std::remove_if(m_queues.begin(),
+                         m_queues.end(),
+                         [](const std::weak_ptr<iqueue_impl>& known) {
+                             return known.expired();
+                         }),
+          m_queues.end());
+        m_queues.push_back(q);
+    }
+
+    // raise all queues we may wait for to the priority of the waiter
+    void boost_queues(queue_priority priority)
+    {
+        // pick one queue at a time so that no copy of the list is
+        // needed and boost() is never invoked while holding m_CS
+        for (size_t i = 0;; ++i) {
+            iqueue_impl_ptr q;
+            {
+                std::lock_guard<std::mutex> lock(m_CS);
+                if (i >= m_queues.size()) {
+                    return;
+                }
+                q = m_queues[i].lock();
+            }
+            if (q) {
+                q->boost(priority);
+            }
+        }
+    }
 };
 
 igroup_impl_ptr
 backend::create_group(backend_type backend)
 {
-    return std::make_shared<group_impl>(global_threadpool(), backend);
+    return std::make_shared<group_impl>(backend);
 }
 
 } // namespace naive
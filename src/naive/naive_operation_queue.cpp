@@ -20,10 +20,11 @@
  */
 
 #include "naive_operation_queue.h"
-#include "naive_operation_queue_manager.h"
 #include "naive_thread.h"
 #include "naive_inverse_lockguard.h"
 
+#include "xdispatch/impl/lightweight_barrier.h"
+
 #include "../thread_utils.h"
 #include "../trace_utils.h"
 
@@ -31,73 +32,61 @@ __XDISPATCH_BEGIN_NAMESPACE
 namespace naive {
 
 #define XDISPATCH_Q_TRACE(msg)                                                 \
-    XDISPATCH_TRACE() << "Queue '" << m_label << "' " msg " ("                 \
+    XDISPATCH_TRACE() << "Queue '" << label() << "' " msg " ("                 \
                       << m_jobs.size() << " jobs)"
-#define XDISPATCH_Q_WARNING(msg)                                               \
-    XDISPATCH_WARNING() << "Queue '" << m_label << "' " msg " ("               \
-                        << m_jobs.size() << " jobs)"
 
 operation_queue::operation_queue(const ithreadpool_ptr& threadpool,
                                  const std::string& label,
-                                 queue_priority priority)
-  : m_label(label)
+                                 queue_priority priority,
+                                 memory_resource* resource)
+  : operation()
+  , m_label(trace_utils::is_debug_enabled() ? new std::string(label)
+                                            : nullptr)
+  , m_threadpool(threadpool)
+  , m_jobs(resource)
   , m_priority(priority)
-  , m_jobs()
+  , m_boost(priority)
   , m_CS()
-  , m_active_drain(false)
-  , m_is_attached(false)
-  , m_notify_operation(make_operation(this, &operation_queue::drain))
-  , m_threadpool(threadpool)
+  , m_draining(false)
 {}
 
-// helper to introduce a delay into a loop condition
-inline bool
-yield_drain()
+const std::string&
+operation_queue::label() const
 {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    return true;
+    static const std::string s_empty;
+    return m_label ? *m_label : s_empty;
 }
 
-operation_queue::~operation_queue()
+void
+operation_queue::operator()()
 {
-    // ensure no new notifications can get queued
-    // wait for calls to drain() to return so that
-    // no dangling pointer access may happen on a different
-    // thread.
-    bool active_drain = false;
-    do {
-        std::lock_guard<std::mutex> lock(m_CS);
-        m_notify_operation.reset();
-        active_drain = m_active_drain;
-    }
-    // delay to give other threads a chance to proceed
-    // if the drain is active
-    while (active_drain && yield_drain());
-
-    // release the threadpool
-    m_threadpool.reset();
+    drain();
 }
 
-class drain_scope
+// the queue currently executing a job on this thread
+static thread_local operation_queue* s_current_queue = nullptr;
+
+current_queue_scope::current_queue_scope(operation_queue* queue)
+  : m_previous(s_current_queue)
 {
-public:
-    drain_scope(bool& active_drain)
-      : m_active_drain(active_drain)
-    {
-        m_active_drain = true;
-    }
-    drain_scope(const drain_scope&) = delete;
+    s_current_queue = queue;
+}
 
-    ~drain_scope() { m_active_drain = false; }
+current_queue_scope::~current_queue_scope()
+{
+    s_current_queue = m_previous;
+}
 
-private:
-    bool& m_active_drain;
-};
+operation_queue*
+current_queue_scope::current()
+{
+    return s_current_queue;
+}
 
 class deferred_pop
 {
 public:
-    explicit deferred_pop(std::list<operation_ptr>& list, size_t& remaining)
+    explicit deferred_pop(operation_ring& list, size_t& remaining)
       : m_list(list)
       , m_remaining(remaining)
     {}
@@ -112,7 +101,7 @@ public:
     }
 
 private:
-    std::list<operation_ptr>& m_list;
+    operation_ring& m_list;
     size_t& m_remaining;
 };
 
@@ -120,11 +109,16 @@ void
 operation_queue::drain()
 {
     if (trace_utils::is_debug_enabled()) {
-        thread_utils::set_current_thread_name(m_label);
+        thread_utils::set_current_thread_name(label());
+    }
+
+    std::unique_lock<spinlock> lock(m_CS);
+    if (m_draining) {
+        // a boosted wakeup and the regular one may both be pending,
+        // the one executing first takes care of all jobs
+        return;
     }
 
-    std::lock_guard<std::mutex> lock(m_CS);
-    drain_scope scope(m_active_drain);
     // we need to satisfy several constraints here:
     // 1. do not remove the entry from m_jobs
     //    until AFTER it has been executed so that async()
@@ -135,104 +129,187 @@ operation_queue::drain()
     // 3. only execute a limited amount of operations to ensure
     //    fair use of the draining thread in case jobs get
     //    added quickly
+    // 4. idle queues yield after every operation so that
+    //    other work can take over the thread as soon as possible
     static constexpr size_t kMaxOpsPerDrain = 10;
-    auto remaining = std::min(m_jobs.size(), kMaxOpsPerDrain);
+    const size_t max_ops =
+      queue_priority::IDLE == m_priority ? 1 : kMaxOpsPerDrain;
+    auto remaining = std::min(m_jobs.size(), max_ops);
+    m_draining = true;
     while (0 != remaining) {
-        operation_ptr job;
+        inline_operation job;
         deferred_pop pop(m_jobs, remaining);
-        std::swap(m_jobs.front(), job);
+        job = std::move(m_jobs.front());
         {
-            inverse_lock_guard<std::mutex> unlock(m_CS);
+            inverse_lock_guard<spinlock> unlock(m_CS);
+            current_queue_scope current(this);
             if (job) {
-                process_job(*job);
+                process_job(job);
                 job.reset();
             }
         }
     }
-    if (!m_jobs.empty()) {
-        // not all jobs have been drained but to ensure fairness
-        // we do not continue but let others make use of our thread
-        // first. Queue another wakeup from here
-        XDISPATCH_Q_TRACE("yield");
-        notify_unsafe();
+    m_draining = false;
+    if (m_jobs.empty()) {
+        m_boost = m_priority;
+        return;
     }
+
+    // not all jobs have been drained but to ensure fairness
+    // we do not continue but let others make use of our thread
+    // first. Queue another wakeup from here
+    XDISPATCH_Q_TRACE("yield");
+    const auto wakeup = m_boost;
+    lock.unlock();
+    notify(wakeup);
 }
 
 void
-operation_queue::notify_unsafe()
+operation_queue::notify(queue_priority priority)
 {
-    if (m_notify_operation) {
-        XDISPATCH_Q_TRACE("notify");
-        m_threadpool->execute(m_notify_operation, m_priority);
-    } else {
-        XDISPATCH_Q_WARNING("detached, dropping operation");
-    }
+    // the wakeup shares ownership with this queue so that
+    // we stay alive until all queued jobs have been run. Never
+    // invoked while holding m_CS as passing the wakeup to the
+    // threadpool may take a while
+    m_threadpool->execute(shared_from_this(), inherit_priority(priority));
 }
 
 void
-operation_queue::async_unsafe(operation_ptr&& job)
+operation_queue::boost(queue_priority priority)
+{
+    {
+        std::lock_guard<spinlock> lock(m_CS);
+        if (m_jobs.empty() || !is_more_urgent(priority, m_boost)) {
+            return;
+        }
+
+        m_boost = priority;
+        if (m_draining) {
+            // the active drain will pick up the boost when yielding
+            return;
+        }
+        XDISPATCH_Q_TRACE("boost");
+    }
+
+    // the pending wakeup may be stuck behind other work of the original
+    // priority, pass another one using the raised priority instead
+    m_threadpool->execute(shared_from_this(), priority);
+}
+
+bool
+operation_queue::async_unsafe(inline_operation&& job)
 {
     // we only need to notify, i.e. wake the thread
     // if all previous jobs have been COMPLETED. Elsewise
     // the thread is awake anyways and we can spare the overhead
-    const bool notify = m_jobs.empty();
+    const bool notify = m_jobs.empty() && !m_draining;
     m_jobs.push_back(std::move(job));
-    if (notify && m_is_attached) {
-        notify_unsafe();
+    if (notify) {
+        XDISPATCH_Q_TRACE("notify");
     }
+    return notify;
 }
 
 void
 operation_queue::async(const operation_ptr& job)
 {
     // preallocate outside the lock
-    operation_ptr job2 = job;
+    async(inline_operation(job));
+}
 
-    std::lock_guard<std::mutex> lock(m_CS);
-    async_unsafe(std::move(job2));
+void
+operation_queue::async(inline_operation&& job)
+{
+    queue_priority wakeup;
+    {
+        std::lock_guard<spinlock> lock(m_CS);
+        if (!async_unsafe(std::move(job))) {
+            return;
+        }
+        wakeup = m_boost;
+    }
+    notify(wakeup);
 }
 
 void
-operation_queue::attach()
+operation_queue::async_bulk(std::vector<inline_operation>& jobs)
 {
-    std::lock_guard<std::mutex> lock(m_CS);
+    bool notify_needed = false;
+    queue_priority wakeup;
+    {
+        std::lock_guard<spinlock> lock(m_CS);
+        // only the first job may need to notify
+        for (auto& job : jobs) {
+            notify_needed |= async_unsafe(std::move(job));
+        }
+        wakeup = m_boost;
+    }
+    if (notify_needed) {
+        notify(wakeup);
+    }
+}
 
-    const auto this_ptr = shared_from_this();
-    XDISPATCH_ASSERT(this_ptr);
-    operation_queue_manager::instance().attach(this_ptr);
+void
+operation_queue::sync(const operation_ptr& job, bool allow_inline)
+{
+    if (this == s_current_queue) {
+        // we are executing on this queue already, waiting
+        // for the queue to become available would deadlock
+        execute_sync(*job);
+        return;
+    }
+
+    if (allow_inline && try_sync_inline(*job)) {
+        return;
+    }
+
+    lightweight_barrier barrier;
+    async(make_operation([&barrier, &job] {
+        process_job(*job);
+        barrier.complete();
+    }));
 
-    m_is_attached = true;
+    wait_helping(barrier);
 }
 
-void
-operation_queue::detach()
+bool
+operation_queue::try_sync_inline(operation& job)
 {
-    std::lock_guard<std::mutex> lock(m_CS);
-    const auto empty = m_jobs.empty();
-
-    if (empty) {
-        // if there is no jobs remaining, there is no chance anymore for
-        // an operation to be dispatched. As such we can cut it short
-        // and skip the wakeup of our thread, directly unregistering
-        // with the manager instead as no barrier is needed
-        operation_queue_manager::instance().detach(this);
-    } else {
-        // queue a final operation which will be executed after
-        // all others which have been queued so far. The final
-        // operation will make sure to unregister with the queue
-        // manager and hence release the operation_queue
-        auto detach_op = make_operation(
-          [this] { operation_queue_manager::instance().detach(this); });
-        async_unsafe(std::move(detach_op));
+    std::unique_lock<spinlock> lock(m_CS);
+    if (!m_jobs.empty() || m_draining) {
+        return false;
+    }
+
+    // occupy the queue while executing on the calling thread. Jobs
+    // queued in the meantime will find the queue busy and not notify
+    // the thread, the same as during a regular drain
+    m_draining = true;
+    {
+        inverse_lock_guard<spinlock> unlock(m_CS);
+        current_queue_scope current(this);
+        execute_sync(job);
     }
+    m_draining = false;
 
-    // prevent any further notifications to be made for
-    // jobs queued after detaching
-    m_is_attached = false;
+    if (!m_jobs.empty()) {
+        // hand jobs queued in the meantime over to the thread
+        XDISPATCH_Q_TRACE("resume after sync");
+        const auto wakeup = m_boost;
+        lock.unlock();
+        notify(wakeup);
+    }
+    return true;
+}
+
+void
+operation_queue::execute_sync(operation& job)
+{
+    process_job(job);
 }
 
+template<typename Job>
 void
-operation_queue::process_job(operation& job)
+operation_queue::process_job(Job& job)
 {
 #if !(defined DEBUG)
     try
@@ -22,10 +22,11 @@
 #ifndef XDISPATCH_NAIVE_CONTEXTQUEUE_H_
 #define XDISPATCH_NAIVE_CONTEXTQUEUE_H_
 
-#include <list>
-#include <mutex>
+#include <vector>
 
 #include "naive_backend_internal.h"
+#include "naive_operation_ring.h"
+#include "naive_spinlock.h"
 
 __XDISPATCH_BEGIN_NAMESPACE
 namespace naive {
@@ -33,24 +34,22 @@ namespace naive {
 /**
     A threadsafe queue which will maintain operations for execution
 
-    After creation the owner of the operation_queue is required to
-    attach() it so that the queue registers with the manager and its
-    notification and lifetime management become active.
-
     If an operation is queued it will be automatically dispatched
     onto the associated thread. Unnecessary thread wakeups will
     be optimized by not waking an already active thread again.
 
-    As soon as the owner has no use for the operation_queue
-    and also has no intend to queue operations to it anymore, it
-    is required to detach() it. This will dispatch one last
-    operation which acts as a kind of barrier making sure that
-    the queue unregisters with the manager again and goes out of
-    scope with the last operation completing.
+    Every wakeup passed to the thread shares ownership of the queue,
+    i.e. the owner may release its reference at any time and the queue
+    will go out of scope with the last queued operation completing.
 
-    @see operation_queue_manager
+    The queue is kept as compact as possible so that millions of
+    instances can be alive at the same time. The queue itself is the
+    operation used for the wakeup and the label is only stored when
+    debugging is enabled.
  */
-class operation_queue : public std::enable_shared_from_this<operation_queue>
+class operation_queue
+  : public operation
+  , public std::enable_shared_from_this<operation_queue>
 {
 public:
     /**
@@ -58,67 +57,122 @@ public:
        operations will be eventually executed on
         @param label The label by which the queue is known
         @param priority The priority at which the queue operates
+        @param resource The memory_resource to allocate buffers from
      */
     operation_queue(const ithreadpool_ptr& thread,
                     const std::string& label,
-                    queue_priority priority);
+                    queue_priority priority,
+                    memory_resource* resource);
 
     /**
-        @brief Destructor
+        @brief Enqueues the passed job for async execution in the queue
      */
-    ~operation_queue();
+    void async(const operation_ptr& job);
 
     /**
         @brief Enqueues the passed job for async execution in the queue
+     */
+    void async(inline_operation&& job);
 
-        @remark A queue needs to have been attached for this to show an effect
+    /**
+        @brief Enqueues all passed jobs at once, moving them out of jobs
      */
-    void async(const operation_ptr& job);
+    void async_bulk(std::vector<inline_operation>& jobs);
 
     /**
-        @brief Marks the queue as active
+        @brief Executes the passed job in the queue and waits for it to
+       complete
 
-        After attaching a queue it is registered with the queue manager
-        and may receive operations for async execution. It is ensured
-        that the queue object cannot go out of scope until detach()
-        has been called.
+        If invoked from within a job executing on this queue, the job is
+        executed immediately to prevent a deadlock. Otherwise, if allowed
+        and the queue is idle, the job is executed on the calling thread
+        while all other jobs are held back. Only a busy queue will cause
+        the job to be queued and the calling thread to wait.
 
-        @see operation_queue_manager
+        @param allow_inline Pass false if jobs must only be executed on the
+       thread(s) of the threadpool the queue was created with
      */
-    void attach();
+    void sync(const operation_ptr& job, bool allow_inline);
 
     /**
-        @brief Marks the queue as inactive
+        @returns The priority at which the queue operates
+     */
+    queue_priority priority() const { return m_priority; }
 
-        No further operations can be queued for async execution anymore.
+    /**
+        @returns The memory_resource the queue allocates from
+     */
+    memory_resource* resource() const { return m_jobs.resource(); }
 
-        The queue will unregister from the queue manager as soon
-        as the last operation which had been queued until this point
-        has executed. After unregistering the queue will go out of scope.
+    /**
+        @brief Raises the priority of the queue until it ran empty
 
-        @see operation_queue_manager
+        Use this when waiting for jobs of this queue from a context with
+        the given priority so that the jobs are not starved by other
+        work of the queue's original priority.
      */
-    void detach();
+    void boost(queue_priority priority);
+
+protected:
+    /**
+        @brief Drains the queue, invoked by the threadpool on wakeup
+     */
+    void operator()() override;
+
+    /**
+        @brief Executes a job passed to sync() on the calling thread
+
+        Only invoked while the job is executed in place of the queue,
+        i.e. either nested within another job of the queue or while
+        all other jobs of the queue are held back.
+     */
+    virtual void execute_sync(operation& job);
 
 private:
-    const std::string m_label;
+    // only set when debugging is enabled
+    const std::unique_ptr<const std::string> m_label;
+    const ithreadpool_ptr m_threadpool;
+    operation_ring m_jobs;
     const queue_priority m_priority;
-    std::list<operation_ptr> m_jobs;
-    std::mutex m_CS;
-    bool m_active_drain;
-    bool m_is_attached;
-    operation_ptr m_notify_operation;
-    ithreadpool_ptr m_threadpool;
+    // the priority to schedule wakeups with, protected by m_CS
+    queue_priority m_boost;
+    spinlock m_CS;
+    // set while jobs are executed, protected by m_CS
+    bool m_draining;
 
+    const std::string& label() const;
     void drain();
-    void async_unsafe(operation_ptr&& job);
-    void notify_unsafe();
+    bool async_unsafe(inline_operation&& job);
+    void notify(queue_priority priority);
+    bool try_sync_inline(operation& job);
 
-    static void process_job(operation& job);
+    template<typename Job>
+    static void process_job(Job& job);
 };
 
 using operation_queue_ptr = std::shared_ptr<operation_queue>;
 
+/**
+    Marks the given queue as executing a job on the calling thread for
+    as long as the scope is alive
+ */
+class current_queue_scope
+{
+public:
+    explicit current_queue_scope(operation_queue* queue);
+    current_queue_scope(const current_queue_scope&) = delete;
+
+    ~current_queue_scope();
+
+    /**
+        @returns the queue executing a job on the calling thread
+     */
+    static operation_queue* current();
+
+private:
+    operation_queue* const m_previous;
+};
+
 } // namespace naive
 __XDISPATCH_END_NAMESPACE
 
@@ -0,0 +1,160 @@
+/*
+ * naive_operation_ring.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XDISPATCH_NAIVE_OPERATION_RING_H_
+#define XDISPATCH_NAIVE_OPERATION_RING_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "naive_backend_internal.h"
+#include "naive_recycling_pool.h"
+
+__XDISPATCH_BEGIN_NAMESPACE
+namespace naive {
+
+/**
+    @brief A fifo of operations stored in a ring buffer
+
+    No storage is allocated until the first operation gets added.
+    The buffer grows as needed and is released again once it drained,
+    so that idle rings do not keep any memory occupied.
+
+    The buffer is obtained from the memory_resource passed on
+    construction. Buffers of the initial capacity taken from
+    new_delete_resource() are recycled via a recycling_pool instead, so
+    that queues woken up for single operations do not allocate.
+
+    This is not threadsafe, access needs to be protected by the owner.
+ */
+class operation_ring
+{
+public:
+    explicit operation_ring(memory_resource* resource)
+      : m_resource(resource)
+      , m_buffer(nullptr)
+      , m_head(0)
+      , m_size(0)
+      , m_capacity(0)
+    {
+        XDISPATCH_ASSERT(m_resource);
+    }
+    operation_ring(const operation_ring&) = delete;
+
+    ~operation_ring() { release(); }
+
+    inline memory_resource* resource() const { return m_resource; }
+
+    inline bool empty() const { return 0 == m_size; }
+
+    inline size_t size() const { return m_size; }
+
+    inline inline_operation& front()
+    {
+        XDISPATCH_ASSERT(m_size > 0);
+        return m_buffer[m_head];
+    }
+
+    inline void push_back(inline_operation&& op)
+    {
+        if (m_size == m_capacity) {
+            grow();
+        }
+        m_buffer[(m_head + m_size) & (m_capacity - 1)] = std::move(op);
+        ++m_size;
+    }
+
+    inline void pop_front()
+    {
+        XDISPATCH_ASSERT(m_size > 0);
+        m_buffer[m_head].reset();
+        m_head = (m_head + 1) & (m_capacity - 1);
+        if (0 == --m_size) {
+            m_head = 0;
+            release();
+        }
+    }
+
+private:
+    // needs to be a power of two
+    static constexpr std::uint32_t kInitialCapacity = 4;
+
+    using initial_pool = recycling_pool<recycled_block_size(
+      kInitialCapacity * sizeof(inline_operation))>;
+    static_assert(alignof(inline_operation) <= alignof(std::max_align_t),
+                  "Recycled buffers are not suitably aligned");
+
+    memory_resource* const m_resource;
+    inline_operation* m_buffer;
+    std::uint32_t m_head;
+    std::uint32_t m_size;
+    std::uint32_t m_capacity;
+
+    void grow()
+    {
+        const auto capacity = m_capacity ? 2 * m_capacity : kInitialCapacity;
+        auto* const buffer = static_cast<inline_operation*>(
+          is_pooled(capacity)
+            ? initial_pool::allocate()
+            : m_resource->allocate(capacity * sizeof(inline_operation),
+                                   alignof(inline_operation)));
+        for (std::uint32_t i = 0; i < capacity; ++i) {
+            new (buffer + i) inline_operation();
+        }
+        for (std::uint32_t i = 0; i < m_size; ++i) {
+            buffer[i] = std::move(m_buffer[(m_head + i) & (m_capacity - 1)]);
+        }
+        release();
+        m_buffer = buffer;
+        m_capacity = capacity;
+        m_head = 0;
+    }
+
+    void release()
+    {
+        if (!m_buffer) {
+            return;
+        }
+        for (std::uint32_t i = 0; i < m_capacity; ++i) {
+            m_buffer[i].~inline_operation();
+        }
+        if (is_pooled(m_capacity)) {
+            initial_pool::deallocate(m_buffer);
+        } else {
+            m_resource->deallocate(m_buffer,
+                                   m_capacity * sizeof(inline_operation),
+                                   alignof(inline_operation));
+        }
+        m_buffer = nullptr;
+        m_capacity = 0;
+    }
+
+    bool is_pooled(std::uint32_t capacity) const
+    {
+        return kInitialCapacity == capacity &&
+               new_delete_resource() == m_resource;
+    }
+};
+
+} // namespace naive
+__XDISPATCH_END_NAMESPACE
+
+#endif /* XDISPATCH_NAIVE_OPERATION_RING_H_ */
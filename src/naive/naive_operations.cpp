@@ -51,7 +51,8 @@ apply_operation::operator()()
 void
 delayed_operation::create_and_dispatch(itimer_impl_ptr&& timer,
                                        std::chrono::milliseconds delay,
-                                       const operation_ptr& op)
+                                       const operation_ptr& op,
+                                       memory_resource* resource)
 {
     // this is using a little trick to make the operation self hosted
     // while still ensuring the timer object gets released accordingly:
@@ -63,7 +64,8 @@ delayed_operation::create_and_dispatch(itimer_impl_ptr&& timer,
     //    cancel and release the timer hence breaking the circular
     //    ownership and ensuring a clean destruction sequence
 
-    auto delayed_op = std::make_shared<delayed_operation>(std::move(timer), op);
+    auto delayed_op = make_recycled<delayed_operation>(
+      resource, std::move(timer), op);
 
     delayed_op->m_timer->handler(delayed_op);
     delayed_op->m_timer->resume(delay);
@@ -92,21 +94,5 @@ delayed_operation::operator()()
     }
 }
 
-consuming_operation::consuming_operation(const operation_ptr& op,
-                                         const consumable_ptr& consumable)
-  : m_op(op)
-  , m_consumable(consumable)
-{}
-
-void
-consuming_operation::operator()()
-{
-    execute_operation_on_this_thread(*m_op);
-
-    if (m_consumable) {
-        m_consumable->consume_resource();
-    }
-}
-
 } // namespace naive
 __XDISPATCH_END_NAMESPACE
@@ -21,6 +21,7 @@
 
 #include "xdispatch/dispatch.h"
 #include "naive_consumable.h"
+#include "naive_recycling_pool.h"
 
 #ifndef XDISPATCH_NAIVE_OPERATIONS_H_
     #define XDISPATCH_NAIVE_OPERATIONS_H_
@@ -32,7 +33,9 @@ namespace naive {
     @brief An operation grouping an iteration operation and
            invoking iterator together in a single call
  */
-class apply_operation : public operation
+class apply_operation
+  : public operation
+  , public recycled<apply_operation>
 {
 public:
     /**
@@ -66,7 +69,7 @@ class delayed_operation : public operation
 {
 public:
     /**
-       @brief Do not use, public to support std::make_shared
+       @brief Do not use, public to support std::allocate_shared
      */
     delayed_operation(itimer_impl_ptr&& timer,
                       const operation_ptr& op,
@@ -76,10 +79,12 @@ public:
        @param timer The timer used for delayed execution
        @param op The operation to be executed after delay
        @param consumable The consumable to notify when done
+       @param resource The memory_resource to allocate the operation from
      */
     static void create_and_dispatch(itimer_impl_ptr&& timer,
                                     std::chrono::milliseconds delay,
-                                    const operation_ptr& op);
+                                    const operation_ptr& op,
+                                    memory_resource* resource);
 
     /**
         @copydoc operation::operator()()
@@ -92,29 +97,6 @@ private:
     const consumable_ptr m_consumable;
 };
 
-/**
-    @brief An operation notifying a consumable when done
- */
-class consuming_operation : public operation
-{
-public:
-    /**
-       @param op The operation to be executed
-       @param consumable The consumable to notify when done
-     */
-    consuming_operation(const operation_ptr& op,
-                        const consumable_ptr& consumable);
-
-    /**
-        @copydoc operation::operator()()
-     */
-    void operator()() final;
-
-private:
-    const operation_ptr m_op;
-    const consumable_ptr m_consumable;
-};
-
 } // namespace naive
 __XDISPATCH_END_NAMESPACE
 
@@ -22,80 +22,188 @@
 #include "xdispatch/impl/iqueue_impl.h"
 
 #include "naive_backend_internal.h"
+#include "naive_concurrent_operation_queue.h"
+#include "naive_recycling_pool.h"
 #include "naive_threadpool.h"
-#include "naive_operation_queue_manager.h"
 
 __XDISPATCH_BEGIN_NAMESPACE
 namespace naive {
 
+// the queue is its own concurrent_operation_queue so that it is
+// kept alive by pending operations, just like serial queues
 class parallel_queue_impl
-  : public std::enable_shared_from_this<parallel_queue_impl>
-  , public iqueue_impl
+  : public iqueue_impl
+  , public concurrent_operation_queue
 {
 public:
     parallel_queue_impl(const ithreadpool_ptr& pool,
                         const queue_priority priority,
-                        backend_type backend)
+                        backend_type backend,
+                        memory_resource* resource,
+                        size_t max_width,
+                        bool global)
       : iqueue_impl()
+      , concurrent_operation_queue(pool, priority, resource, max_width)
       , m_backend(backend)
-      , m_pool(pool)
-      , m_priority(priority)
+      , m_global(global)
     {
-        XDISPATCH_ASSERT(m_pool);
-        operation_queue_manager::instance().attach(m_pool);
+        XDISPATCH_ASSERT(pool);
     }
 
-    ~parallel_queue_impl() override
+    void async(const operation_ptr& op) final
     {
-        operation_queue_manager::instance().detach(m_pool.get());
+        concurrent_operation_queue::async(op);
     }
 
-    void async(const operation_ptr& op) final
+    void async_inline(inline_operation&& op) final
+    {
+        concurrent_operation_queue::async(std::move(op));
+    }
+
+    void barrier_async(const operation_ptr& op) final
     {
-        m_pool->execute(op, m_priority);
+        if (m_global) {
+            // the global queues are shared by everyone, a barrier
+            // would stall all unrelated work. Behave like libdispatch
+            concurrent_operation_queue::async(op);
+            return;
+        }
+        concurrent_operation_queue::barrier_async(op);
     }
 
     void apply(size_t times, const iteration_operation_ptr& op) final
     {
-        const auto completed = std::make_shared<consumable>(times);
+        const auto completed = make_recycled<consumable>(resource(), times);
         for (size_t i = 0; i < times; ++i) {
-            async(std::make_shared<apply_operation>(i, op, completed));
+            async_inline(inline_operation(make_recycled_ref<apply_operation>(
+              resource(), i, op, completed)));
         }
         completed->wait_for_consumed();
     }
 
     void after(std::chrono::milliseconds delay, const operation_ptr& op) final
     {
-        auto timer =
-          backend_for_type(m_backend).create_timer(shared_from_this());
-        delayed_operation::create_and_dispatch(std::move(timer), delay, op);
+        auto timer = backend_for_type(m_backend).create_timer(
+          std::static_pointer_cast<parallel_queue_impl>(shared_from_this()));
+        delayed_operation::create_and_dispatch(
+          std::move(timer), delay, op, resource());
     }
 
     backend_type backend() final { return m_backend; }
 
+    queue_priority priority() final
+    {
+        return concurrent_operation_queue::priority();
+    }
+
+    memory_resource* resource() final
+    {
+        return concurrent_operation_queue::resource();
+    }
+
+protected:
+    void execute(inline_operation& job) final
+    {
+        executing_queue_scope executing(this);
+        execute_operation_on_this_thread(job);
+    }
+
 private:
     const backend_type m_backend;
-    ithreadpool_ptr m_pool;
-    const queue_priority m_priority;
+    const bool m_global;
 };
 
+static iqueue_impl_ptr
+make_parallel_queue(const ithreadpool_ptr& pool,
+                    queue_priority priority,
+                    backend_type backend,
+                    memory_resource* resource,
+                    size_t max_width =
+                      concurrent_operation_queue::unlimited_width,
+                    bool global = false)
+{
+    XDISPATCH_ASSERT(pool);
+    XDISPATCH_ASSERT(max_width > 0);
+    // the queue itself is allocated from the resource as well
+    if (!resource) {
+        resource = pool->resource();
+    }
+    return std::allocate_shared<parallel_queue_impl>(
+      polymorphic_allocator<parallel_queue_impl>(resource),
+      pool,
+      priority,
+      backend,
+      resource,
+      max_width,
+      global);
+}
+
 queue
 create_parallel_queue(const std::string& label,
                       const ithreadpool_ptr& pool,
-                      queue_priority priority)
+                      queue_priority priority,
+                      memory_resource* resource)
 {
-    return create_parallel_queue(label, pool, priority, backend_type::naive);
+    return create_parallel_queue(
+      label, pool, priority, backend_type::naive, resource);
 }
 
 queue
 create_parallel_queue(const std::string& label,
                       const ithreadpool_ptr& pool,
                       queue_priority priority,
-                      backend_type backend)
+                      backend_type backend,
+                      memory_resource* resource)
 {
-    XDISPATCH_ASSERT(pool);
+    return queue(label,
+                 make_parallel_queue(pool, priority, backend, resource));
+}
+
+queue
+create_concurrent_queue(const std::string& label,
+                        size_t max_width,
+                        queue_priority priority,
+                        memory_resource* resource)
+{
+    auto& naive = static_cast<backend&>(backend_for_type(backend_type::naive));
     return queue(
-      label, std::make_shared<parallel_queue_impl>(pool, priority, backend));
+      label,
+      naive.create_concurrent_queue(label, max_width, priority, resource));
+}
+
+queue
+create_concurrent_queue(const std::string& label,
+                        size_t max_width,
+                        const ithreadpool_ptr& pool,
+                        queue_priority priority,
+                        memory_resource* resource)
+{
+    return create_concurrent_queue(
+      label, max_width, pool, priority, backend_type::naive, resource);
+}
+
+queue
+create_concurrent_queue(const std::string& label,
+                        size_t max_width,
+                        const ithreadpool_ptr& pool,
+                        queue_priority priority,
+                        backend_type backend,
+                        memory_resource* resource)
+{
+    return queue(
+      label,
+      make_parallel_queue(pool, priority, backend, resource, max_width));
+}
+
+iqueue_impl_ptr
+backend::create_concurrent_queue(const std::string& /*label*/,
+                                 size_t max_width,
+                                 queue_priority priority,
+                                 backend_type backend,
+                                 memory_resource* resource)
+{
+    return make_parallel_queue(
+      global_threadpool(), priority, backend, resource, max_width);
 }
 
 iqueue_impl_ptr
@@ -103,8 +211,13 @@ backend::create_parallel_queue(const std::string& /*label*/,
                                queue_priority priority,
                                backend_type backend)
 {
-    return std::make_shared<parallel_queue_impl>(
-      global_threadpool(), priority, backend);
+    // only used for the global queues
+    return make_parallel_queue(global_threadpool(),
+                               priority,
+                               backend,
+                               nullptr,
+                               concurrent_operation_queue::unlimited_width,
+                               true);
 }
 
 } // namespace naive
@@ -0,0 +1,383 @@
+/*
+ * naive_recycling_pool.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef XDISPATCH_NAIVE_RECYCLING_POOL_H_
+#define XDISPATCH_NAIVE_RECYCLING_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+
+#include "xdispatch/dispatch.h"
+
+__XDISPATCH_BEGIN_NAMESPACE
+namespace naive {
+
+/**
+    @returns The size of the blocks used to store objects of the given
+             size, rounded so that similar types share a single pool
+ */
+constexpr size_t
+recycled_block_size(size_t size)
+{
+    return (size + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) *
+           alignof(std::max_align_t);
+}
+
+/**
+    @brief A freelist of memory blocks of a fixed size
+
+    Blocks released on a thread are cached by that thread and handed out
+    again on its next allocation, so that internal operations created and
+    destroyed continuously do not need to call into the system allocator.
+
+    Once a thread cached more than thread_limit blocks, a batch of them
+    is moved to a freelist shared by all threads. Threads running out of
+    cached blocks refill their cache from there before allocating new
+    blocks. This covers the common case of blocks allocated on one thread
+    and released on another. Blocks exceeding global_limit are returned
+    to the system.
+ */
+template<size_t Size>
+class recycling_pool
+{
+public:
+    static_assert(Size >= sizeof(void*), "Blocks must hold a pointer");
+
+    static constexpr size_t thread_limit = 256;
+    static constexpr size_t batch_size = thread_limit / 2;
+    static constexpr size_t global_limit = 64 * thread_limit;
+
+    /**
+        @returns A block of Size bytes, suitably aligned for any type
+     */
+    static void* allocate()
+    {
+        auto& c = cache();
+        if (c.m_blocks.empty() && !c.m_exited) {
+            register_thread(c);
+            auto& s = shared();
+            std::lock_guard<std::mutex> lock(s.m_CS);
+            s.m_blocks.move_to(c.m_blocks, batch_size);
+        }
+        if (!c.m_blocks.empty()) {
+            return c.m_blocks.pop();
+        }
+        return ::operator new(Size);
+    }
+
+    /**
+        @brief Releases a block obtained from allocate()
+     */
+    static void deallocate(void* ptr) noexcept
+    {
+        auto& c = cache();
+        if (c.m_exited) {
+            release_shared(ptr);
+            return;
+        }
+
+        register_thread(c);
+        c.m_blocks.push(ptr);
+        if (c.m_blocks.size() > thread_limit) {
+            auto& s = shared();
+            std::lock_guard<std::mutex> lock(s.m_CS);
+            c.m_blocks.move_to(s.m_blocks, batch_size);
+            while (s.m_blocks.size() > global_limit) {
+                ::operator delete(s.m_blocks.pop());
+            }
+        }
+    }
+
+private:
+    struct block
+    {
+        block* m_next;
+    };
+
+    // a plain list so that it can be zero initialized as thread_local
+    struct block_list
+    {
+        block* m_head;
+        size_t m_size;
+
+        bool empty() const { return nullptr == m_head; }
+
+        size_t size() const { return m_size; }
+
+        void push(void* ptr)
+        {
+            auto* const b = static_cast<block*>(ptr);
+            b->m_next = m_head;
+            m_head = b;
+            ++m_size;
+        }
+
+        void* pop()
+        {
+            auto* const b = m_head;
+            m_head = b->m_next;
+            --m_size;
+            return b;
+        }
+
+        void move_to(block_list& other, size_t count)
+        {
+            while (count-- > 0 && !empty()) {
+                other.push(pop());
+            }
+        }
+    };
+
+    struct thread_cache
+    {
+        block_list m_blocks;
+        bool m_registered;
+        bool m_exited;
+    };
+
+    struct shared_freelist
+    {
+        std::mutex m_CS;
+        block_list m_blocks;
+    };
+
+    // passes the cache of a thread to the shared freelist on exit
+    struct thread_guard
+    {
+        ~thread_guard()
+        {
+            auto& c = cache();
+            c.m_exited = true;
+            auto& s = shared();
+            std::lock_guard<std::mutex> lock(s.m_CS);
+            c.m_blocks.move_to(s.m_blocks, c.m_blocks.size());
+        }
+    };
+
+    static thread_cache& cache()
+    {
+        // trivially destructible so that it stays usable while other
+        // thread local objects are destroyed
+        static thread_local thread_cache s_cache;
+        return s_cache;
+    }
+
+    static shared_freelist& shared()
+    {
+        // never destroyed, blocks may still be released during exit
+        static auto* const s_shared = new shared_freelist{};
+        return *s_shared;
+    }
+
+    static void register_thread(thread_cache& c)
+    {
+        if (!c.m_registered) {
+            c.m_registered = true;
+            static thread_local thread_guard s_guard;
+            (void)s_guard;
+        }
+    }
+
+    static void release_shared(void* ptr)
+    {
+        auto& s = shared();
+        std::lock_guard<std::mutex> lock(s.m_CS);
+        if (s.m_blocks.size() < global_limit) {
+            s.m_blocks.push(ptr);
+            return;
+        }
+        ::operator delete(ptr);
+    }
+};
+
+template<size_t Size>
+constexpr size_t recycling_pool<Size>::thread_limit;
+template<size_t Size>
+constexpr size_t recycling_pool<Size>::batch_size;
+template<size_t Size>
+constexpr size_t recycling_pool<Size>::global_limit;
+
+/**
+    @brief Allocates instances of the deriving class T from a
+           memory_resource
+
+    Instances created via new (resource) T(...) obtain their memory from
+    the given resource, a plain new uses get_default_resource(). Memory
+    for instances of T taken from new_delete_resource() is recycled via
+    a recycling_pool instead.
+
+    Every instance is preceded by a header remembering where its memory
+    came from. The pool is looked up within the operators only as T is
+    still incomplete when deriving from this class.
+ */
+template<class T>
+class recycled
+{
+public:
+    static void* operator new(size_t size)
+    {
+        return recycled::operator new(size, get_default_resource());
+    }
+
+    static void* operator new(size_t size, memory_resource* resource)
+    {
+        using pool =
+          recycling_pool<recycled_block_size(header_size + sizeof(T))>;
+
+        const bool pooled =
+          sizeof(T) == size && new_delete_resource() == resource;
+        void* const block =
+          pooled ? pool::allocate() : resource->allocate(header_size + size);
+        auto* const h = static_cast<header*>(block);
+        h->m_resource = pooled ? nullptr : resource;
+        h->m_size = header_size + size;
+        return static_cast<char*>(block) + header_size;
+    }
+
+    static void operator delete(void* ptr) noexcept { release(ptr); }
+
+    // invoked when the constructor throws
+    static void operator delete(void* ptr, memory_resource*) noexcept
+    {
+        release(ptr);
+    }
+
+private:
+    struct header
+    {
+        memory_resource* m_resource;
+        size_t m_size;
+    };
+
+    static constexpr size_t header_size = recycled_block_size(sizeof(header));
+
+    static void release(void* ptr) noexcept
+    {
+        using pool =
+          recycling_pool<recycled_block_size(header_size + sizeof(T))>;
+
+        if (!ptr) {
+            return;
+        }
+        auto* const h =
+          reinterpret_cast<header*>(static_cast<char*>(ptr) - header_size);
+        if (h->m_resource) {
+            h->m_resource->deallocate(h, h->m_size);
+        } else {
+            pool::deallocate(h);
+        }
+    }
+};
+
+/**
+    @returns A ref_ptr to a new T allocated from the given resource
+
+    T needs to derive from recycled.
+ */
+template<class T, typename... Args>
+inline ref_ptr<T>
+make_recycled_ref(memory_resource* resource, Args&&... args)
+{
+    return ref_ptr<T>(new (resource) T(std::forward<Args>(args)...));
+}
+
+/**
+    @brief A standard allocator handing out single objects from a
+           recycling_pool
+
+    Intended to be used with std::allocate_shared, which allocates a
+    single object holding both the control block and the instance.
+ */
+template<typename T>
+class recycling_allocator
+{
+public:
+    using value_type = T;
+
+    recycling_allocator() = default;
+
+    template<typename U>
+    recycling_allocator(const recycling_allocator<U>&) noexcept
+    {}
+
+    T* allocate(size_t n)
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t),
+                      "Overaligned types are not supported");
+        if (1 == n) {
+            return static_cast<T*>(pool::allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept
+    {
+        if (1 == n) {
+            pool::deallocate(ptr);
+            return;
+        }
+        ::operator delete(ptr);
+    }
+
+private:
+    using pool = recycling_pool<recycled_block_size(sizeof(T))>;
+};
+
+template<typename T, typename U>
+inline bool
+operator==(const recycling_allocator<T>&, const recycling_allocator<U>&)
+{
+    return true;
+}
+
+template<typename T, typename U>
+inline bool
+operator!=(const recycling_allocator<T>&, const recycling_allocator<U>&)
+{
+    return false;
+}
+
+/**
+    @returns A std::shared_ptr to a new T allocated from the given
+             resource
+
+    Memory taken from new_delete_resource() is recycled via a
+    recycling_pool.
+ */
+template<typename T, typename... Args>
+inline std::shared_ptr<T>
+make_recycled(memory_resource* resource, Args&&... args)
+{
+    if (new_delete_resource() == resource) {
+        return std::allocate_shared<T>(recycling_allocator<T>(),
+                                       std::forward<Args>(args)...);
+    }
+    return std::allocate_shared<T>(polymorphic_allocator<T>(resource),
+                                   std::forward<Args>(args)...);
+}
+
+} // namespace naive
+__XDISPATCH_END_NAMESPACE
+
+#endif /* XDISPATCH_NAIVE_RECYCLING_POOL_H_ */
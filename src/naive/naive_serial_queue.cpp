@@ -23,6 +23,7 @@
 
 #include "naive_backend_internal.h"
 #include "naive_operation_queue.h"
+#include "naive_recycling_pool.h"
 #include "naive_threadpool.h"
 
 #include <thread>
@@ -32,72 +33,145 @@
 __XDISPATCH_BEGIN_NAMESPACE
 namespace naive {
 
+// the queue is its own operation_queue so that a serial
+// queue is backed by a single allocation only
 class serial_queue_impl
-  : public std::enable_shared_from_this<serial_queue_impl>
-  , public iqueue_impl
+  : public iqueue_impl
+  , public operation_queue
 {
 public:
     serial_queue_impl(const ithreadpool_ptr& threadpool,
                       const std::string& label,
                       queue_priority priority,
-                      backend_type backend)
+                      backend_type backend,
+                      memory_resource* resource,
+                      bool inline_sync = false)
       : iqueue_impl()
+      , operation_queue(threadpool, label, priority, resource)
       , m_backend(backend)
-      , m_queue(std::make_shared<operation_queue>(threadpool, label, priority))
+      , m_inline_sync(inline_sync)
     {
         XDISPATCH_ASSERT(threadpool);
-        m_queue->attach();
     }
 
-    ~serial_queue_impl() override { m_queue->detach(); }
+    void async(const operation_ptr& op) final { operation_queue::async(op); }
 
-    void async(const operation_ptr& op) final { m_queue->async(op); }
+    void async_inline(inline_operation&& op) final
+    {
+        operation_queue::async(std::move(op));
+    }
+
+    void async_bulk(std::vector<inline_operation>& ops) final
+    {
+        operation_queue::async_bulk(ops);
+    }
+
+    void sync(const operation_ptr& op) final
+    {
+        operation_queue::sync(op, m_inline_sync);
+    }
 
     void apply(size_t times, const iteration_operation_ptr& op) final
     {
-        const auto completed = std::make_shared<consumable>(times);
+        if (executing_queue_scope::current() == this) {
+            // we are executing on this queue already, the iterations
+            // would never be started while we wait for them
+            for (size_t i = 0; i < times; ++i) {
+                execute_operation_on_this_thread(*op, i);
+            }
+            return;
+        }
+
+        const auto completed = make_recycled<consumable>(resource(), times);
         for (size_t i = 0; i < times; ++i) {
-            async(std::make_shared<apply_operation>(i, op, completed));
+            async_inline(inline_operation(make_recycled_ref<apply_operation>(
+              resource(), i, op, completed)));
         }
         completed->wait_for_consumed();
-
-        // FIXME(zwicker): This is blocking and will not work if invoked from
-        // within
-        //                 an operation active on this very same queue
     }
 
     void after(std::chrono::milliseconds delay, const operation_ptr& op) final
     {
-        auto timer =
-          backend_for_type(m_backend).create_timer(shared_from_this());
-        delayed_operation::create_and_dispatch(std::move(timer), delay, op);
+        auto timer = backend_for_type(m_backend).create_timer(
+          std::static_pointer_cast<serial_queue_impl>(shared_from_this()));
+        delayed_operation::create_and_dispatch(
+          std::move(timer), delay, op, resource());
     }
 
     backend_type backend() final { return m_backend; }
 
+    queue_priority priority() final { return operation_queue::priority(); }
+
+    void boost(queue_priority priority) final
+    {
+        operation_queue::boost(priority);
+    }
+
+    memory_resource* resource() final { return operation_queue::resource(); }
+
+protected:
+    void operator()() final
+    {
+        executing_queue_scope executing(this);
+        operation_queue::operator()();
+    }
+
+    void execute_sync(operation& job) final
+    {
+        // only executed on the calling thread in place of the queue
+        executing_queue_scope executing(this);
+        operation_queue::execute_sync(job);
+    }
+
 private:
     const backend_type m_backend;
-    operation_queue_ptr m_queue;
+    // only queues driven by the global threadpool are not bound to
+    // specific threads and may execute operations on any thread
+    const bool m_inline_sync;
 };
 
+static std::shared_ptr<serial_queue_impl>
+make_serial_queue(const ithreadpool_ptr& thread,
+                  const std::string& label,
+                  queue_priority priority,
+                  backend_type backend,
+                  memory_resource* resource,
+                  bool inline_sync = false)
+{
+    XDISPATCH_ASSERT(thread);
+    // the queue itself is allocated from the resource as well
+    if (!resource) {
+        resource = thread->resource();
+    }
+    return std::allocate_shared<serial_queue_impl>(
+      polymorphic_allocator<serial_queue_impl>(resource),
+      thread,
+      label,
+      priority,
+      backend,
+      resource,
+      inline_sync);
+}
+
 queue
 create_serial_queue(const std::string& label,
                     const ithreadpool_ptr& thread,
                     queue_priority priority,
-                    backend_type backend)
+                    backend_type backend,
+                    memory_resource* resource)
 {
-    XDISPATCH_ASSERT(thread);
-    return queue(
-      label,
-      std::make_shared<serial_queue_impl>(thread, label, priority, backend));
+    return queue(label,
+                 make_serial_queue(thread, label, priority, backend, resource));
 }
 
 queue
 create_serial_queue(const std::string& label,
                     const ithreadpool_ptr& thread,
-                    queue_priority priority)
+                    queue_priority priority,
+                    memory_resource* resource)
 {
-    return create_serial_queue(label, thread, priority, backend_type::naive);
+    return create_serial_queue(
+      label, thread, priority, backend_type::naive, resource);
 }
 
 iqueue_impl_ptr
@@ -105,8 +179,8 @@ backend::create_serial_queue(const std::string& label,
                              queue_priority priority,
                              backend_type backend)
 {
-    return std::make_shared<serial_queue_impl>(
-      global_threadpool(), label, priority, backend);
+    return make_serial_queue(
+      global_threadpool(), label, priority, backend, nullptr, true);
 }
 
 static std::shared_ptr<manual_thread>
@@ -121,8 +195,8 @@ main_thread()
 iqueue_impl_ptr
 backend::create_main_queue(const std::string& label, backend_type backend)
 {
-    static iqueue_impl_ptr s_queue = std::make_shared<serial_queue_impl>(
-      main_thread(), label, queue_priority::USER_INTERACTIVE, backend);
+    static iqueue_impl_ptr s_queue = make_serial_queue(
+      main_thread(), label, queue_priority::USER_INTERACTIVE, backend, nullptr);
     return s_queue;
 }
 
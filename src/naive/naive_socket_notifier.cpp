@@ -161,12 +161,16 @@ public:
                     inverse_lock_guard<std::mutex> unlock(this_ptr->m_CS);
 
                     lightweight_barrier barrier;
-                    queue->async(make_operation(
+                    queue->async_inline(inline_operation::make(
                       [handler, socket, type, &barrier, &handler_cancelable] {
-                          cancelable_scope scope(handler_cancelable);
-                          if (scope) {
-                              execute_operation_on_this_thread(
-                                *handler, socket, type);
+                          {
+                              // leave the scope before completing, the
+                              // notifier may get released right afterwards
+                              cancelable_scope scope(handler_cancelable);
+                              if (scope) {
+                                  execute_operation_on_this_thread(
+                                    *handler, socket, type);
+                              }
                           }
                           barrier.complete();
                       }));
@@ -178,8 +182,7 @@ public:
             }
         });
 
-        // FIXME(zwicker): Add accessors to execute with the queue's priority
-        m_pool->execute(socket_notifier_op, queue_priority::DEFAULT);
+        m_pool->execute(socket_notifier_op, m_queue->priority());
     }
 
     void suspend() final
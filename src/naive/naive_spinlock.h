@@ -0,0 +1,82 @@
+/*
+ * naive_spinlock.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XDISPATCH_NAIVE_SPINLOCK_H_
+#define XDISPATCH_NAIVE_SPINLOCK_H_
+
+#include <atomic>
+#include <thread>
+
+#include "naive_backend_internal.h"
+#include "../thread_utils.h"
+
+__XDISPATCH_BEGIN_NAMESPACE
+namespace naive {
+
+/**
+    @brief A lock occupying a single byte
+
+    Suitable for protecting very short critical sections only. Waiting
+    threads will spin for a short while and yield their timeslice
+    afterwards. Satisfies the Lockable requirements so that it can be
+    used with std::lock_guard and inverse_lock_guard.
+ */
+class spinlock
+{
+public:
+    spinlock()
+      : m_locked(false)
+    {}
+    spinlock(const spinlock&) = delete;
+
+    inline void lock()
+    {
+        static constexpr int kMaxSpinsBeforeYield = 100;
+
+        int spins = 0;
+        while (!try_lock()) {
+            // wait for the lock to become available without
+            // writing to it so that the owner is not slowed down
+            while (m_locked.load(std::memory_order_relaxed)) {
+                if (++spins < kMaxSpinsBeforeYield) {
+                    thread_utils::cpu_relax();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    inline bool try_lock()
+    {
+        return !m_locked.exchange(true, std::memory_order_acquire);
+    }
+
+    inline void unlock() { m_locked.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> m_locked;
+};
+
+} // namespace naive
+__XDISPATCH_END_NAMESPACE
+
+#endif /* XDISPATCH_NAIVE_SPINLOCK_H_ */
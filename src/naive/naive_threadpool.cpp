@@ -22,8 +22,8 @@
 #include "../trace_utils.h"
 #include "../thread_utils.h"
 
+#include "naive_operation_queue.h"
 #include "naive_threadpool.h"
-#include "naive_operation_queue_manager.h"
 
 __XDISPATCH_BEGIN_NAMESPACE
 namespace naive {
@@ -43,6 +43,37 @@ ithreadpool::current()
     return s_current_pool;
 }
 
+// the number of nested help_current() invocations on this thread
+static thread_local int s_help_depth = 0;
+
+bool
+ithreadpool::help_current()
+{
+    // every helped operation adds to the stack of the waiting thread
+    static constexpr int skMaxHelpDepth = 8;
+
+    auto* const pool = current();
+    if (!pool || s_help_depth >= skMaxHelpDepth) {
+        return false;
+    }
+    if (current_queue_scope::current()) {
+        // a job of a serial queue is suspended further down the stack.
+        // Helped operations may wait for that queue which cannot make
+        // progress until the job resumed
+        return false;
+    }
+
+    // the helped operation is unrelated to the queue and the batch
+    // of the code waiting further down the stack
+    executing_queue_scope no_executing(nullptr);
+    suspended_batch_scope no_batch;
+
+    ++s_help_depth;
+    const bool executed = pool->try_execute_pending();
+    --s_help_depth;
+    return executed;
+}
+
 void
 ithreadpool::run_with_threadpool(operation& op, ithreadpool* pool)
 {
@@ -64,11 +95,12 @@ ithreadpool::run_with_threadpool(operation& op, ithreadpool* pool)
     execute_operation_on_this_thread(op);
 }
 
-char const* const s_bucket_labels[threadpool::bucket_count] = {
+char const* const s_bucket_labels[threadpool::bucket_count + 1] = {
     k_label_global_INTERACTIVE,
     k_label_global_INITIATED,
     k_label_global_UTILITY,
-    k_label_global_BACKGROUND
+    k_label_global_BACKGROUND,
+    k_label_global_IDLE
 };
 
 class threadpool::data
@@ -81,6 +113,8 @@ public:
       , m_active_threads(0)
       , m_idle_threads(0)
       , m_operations()
+      , m_idle_operations()
+      , m_idle_wakeups(0)
       , m_cancelled(false)
     {
         XDISPATCH_ASSERT(m_max_threads.is_lock_free());
@@ -101,24 +135,41 @@ public:
     // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
     std::array<concurrentqueue<operation_ptr>, bucket_count> m_operations;
     // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    concurrentqueue<operation_ptr> m_idle_operations;
+    // number of releases of the operations counter done on behalf
+    // of idle operations which have not been consumed yet
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    std::atomic<int> m_idle_wakeups;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
     std::atomic<bool> m_cancelled;
 };
 
 class threadpool::worker
 {
 public:
-    explicit worker(const threadpool::data_ptr& data)
-      : m_data(data)
-      , m_thread(&worker::run, this)
-    {}
+    /**
+        @brief Starts a new worker thread
 
-    ~worker()
+        The thread is detached and shares ownership of the pool data,
+        i.e. it cleans up after itself once it ran out of work.
+
+        @returns The id of the new thread
+     */
+    static std::thread::id spawn(const threadpool::data_ptr& data)
     {
-        XDISPATCH_ASSERT(m_thread.joinable());
-        m_thread.join();
+        std::thread thread([data] {
+            worker w(data);
+            w.run();
+        });
+        const auto id = thread.get_id();
+        thread.detach();
+        return id;
     }
 
-    std::thread::id get_id() const { return m_thread.get_id(); }
+private:
+    explicit worker(const threadpool::data_ptr& data)
+      : m_data(data)
+    {}
 
     void run()
     {
@@ -203,6 +254,19 @@ public:
                 //                 queued we will never drain the lower prio ops
                 for (label = 0; !m_data->m_cancelled; ++label) {
                     if (bucket_count == label) {
+                        // all buckets are empty, i.e. we were woken up on
+                        // behalf of an idle operation and would otherwise
+                        // park. We may find it taken by another thread
+                        // already as there is no strict pairing
+                        if (try_consume_idle_wakeup()) {
+                            auto& idle_ops = m_data->m_idle_operations;
+                            while (!idle_ops.try_dequeue(op)) {
+                                // popping may fail spontaneously, but every
+                                // wakeup was posted after enqueueing its
+                                // operation so one is left for us
+                            }
+                            break;
+                        }
                         label = 0;
                     }
 
@@ -212,7 +276,7 @@ public:
                         break;
                     }
                 }
-                XDISPATCH_ASSERT(op);
+                XDISPATCH_ASSERT(op || m_data->m_cancelled);
             }
 
             if (op) {
@@ -232,13 +296,22 @@ public:
         const auto idle =
           m_data->m_idle_threads.load(std::memory_order_consume);
         XDISPATCH_TP_TRACE(m_data->m_pool, remaining, idle)
-          << "Thread" << std::this_thread::get_id() << " joining";
-        operation_queue_manager::instance().detach(this);
+          << "Thread" << std::this_thread::get_id() << " exiting";
+    }
+
+    bool try_consume_idle_wakeup()
+    {
+        int wakeups = m_data->m_idle_wakeups.load(std::memory_order_acquire);
+        while (wakeups > 0) {
+            if (m_data->m_idle_wakeups.compare_exchange_weak(
+                  wakeups, wakeups - 1, std::memory_order_acq_rel)) {
+                return true;
+            }
+        }
+        return false;
     }
 
-private:
     threadpool::data_ptr m_data;
-    std::thread m_thread;
 };
 
 threadpool::threadpool()
@@ -259,9 +332,54 @@ threadpool::~threadpool()
     m_data->m_operations_counter.release(m_data->m_active_threads);
 }
 
+bool
+threadpool::try_execute_pending()
+{
+    if (!m_data->m_operations_counter.try_acquire()) {
+        return false;
+    }
+
+    // only a single pass, idle operations are left to the workers
+    // as a waiting thread does not count as spare capacity
+    operation_ptr op;
+    for (int label = 0; !op && label < bucket_count; ++label) {
+        m_data->m_operations[label].try_dequeue(op);
+    }
+    if (!op) {
+        // pass the count on to a worker which is guaranteed to find
+        // the operation eventually
+        m_data->m_operations_counter.release();
+        return false;
+    }
+
+    run_with_threadpool(*op, this);
+    return true;
+}
+
 void
 threadpool::execute(const operation_ptr& work, const queue_priority priority)
 {
+    if (queue_priority::IDLE == priority) {
+        // idle operations share the operations counter to wake a thread
+        // but are only picked once a thread found all buckets empty, so
+        // operations queued in the meantime will always be preferred.
+        // As every idle operation is executed on its own, it will
+        // yield to other work at operation boundaries.
+        const auto enqueued = m_data->m_idle_operations.enqueue(work);
+        XDISPATCH_ASSERT(enqueued);
+        if (enqueued) {
+            m_data->m_idle_wakeups.fetch_add(1, std::memory_order_release);
+            m_data->m_operations_counter.release();
+        }
+        // a parked thread will pick it up, but no thread is spawned to
+        // compete with the busy ones. Only a pool without any thread
+        // needs one to make progress at all
+        if (0 == m_data->m_active_threads.load(std::memory_order_consume)) {
+            schedule();
+        }
+        return;
+    }
+
     int index = -1;
     switch (priority) {
         case queue_priority::USER_INTERACTIVE:
@@ -277,6 +395,9 @@ threadpool::execute(const operation_ptr& work, const queue_priority priority)
         case queue_priority::BACKGROUND:
             index = bucket_BACKGROUND;
             break;
+        case queue_priority::IDLE:
+            // handled above
+            break;
     }
 
     XDISPATCH_ASSERT(index >= 0);
@@ -324,12 +445,11 @@ threadpool::schedule()
     // check if we are good to create another thread
     else if (active_threads <
              m_data->m_max_threads.load(std::memory_order_consume)) {
-        auto thread = std::make_shared<worker>(m_data);
-        operation_queue_manager::instance().attach(thread);
         m_data->m_active_threads.fetch_add(1, std::memory_order_release);
+        const auto thread_id = worker::spawn(m_data);
 
         XDISPATCH_TP_TRACE(this, active_threads + 1, idle_threads)
-          << "Spawned thread " << thread->get_id()
+          << "Spawned thread " << thread_id
           << " (max=" << m_data->m_max_threads << ")";
     }
     // all threads busy and processor allocation reached, wait
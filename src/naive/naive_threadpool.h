@@ -49,7 +49,11 @@ public:
         bucket_UTILITY = 2,
         bucket_BACKGROUND = 3,
 
-        bucket_count
+        bucket_count,
+
+        // idle operations are kept apart from the buckets above
+        // and only picked up by threads running out of other work
+        bucket_IDLE = bucket_count
     };
 
     /**
@@ -86,6 +90,11 @@ protected:
      */
     void notify_thread_unblocked() final;
 
+    /**
+        @copydoc ithreadpool::try_execute_pending
+     */
+    bool try_execute_pending() final;
+
 private:
     class worker;
     class data;
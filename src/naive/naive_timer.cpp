@@ -103,13 +103,19 @@ public:
                 inverse_lock_guard<std::mutex> unlock(this_ptr->m_CS);
 
                 lightweight_barrier barrier;
-                queue->async(make_operation([handler, &barrier, &cancelable] {
-                    cancelable_scope scope(cancelable);
-                    if (scope) {
-                        execute_operation_on_this_thread(*handler);
-                    }
-                    barrier.complete();
-                }));
+                // stored inline by naive queues, ticks do not allocate
+                queue->async_inline(inline_operation::make(
+                  [handler, &barrier, &cancelable] {
+                      {
+                          // leave the scope before completing, the
+                          // timer may get released right afterwards
+                          cancelable_scope scope(cancelable);
+                          if (scope) {
+                              execute_operation_on_this_thread(*handler);
+                          }
+                      }
+                      barrier.complete();
+                  }));
                 barrier.wait();
 
                 if (interval.count() > 0) {
@@ -121,8 +127,7 @@ public:
             }
         });
 
-        // FIXME(zwicker): Add accessors to execute with the queue's priority
-        m_pool->execute(timer_op, queue_priority::DEFAULT);
+        m_pool->execute(timer_op, m_queue->priority());
     }
 
     void suspend() override
@@ -0,0 +1,224 @@
+/*
+ * prioritized_queue.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "xdispatch_internal.h"
+#include "xdispatch/prioritized_queue.h"
+#include "xdispatch/impl/iqueue_impl.h"
+#include "xdispatch/impl/itimer_impl.h"
+
+__XDISPATCH_USE_NAMESPACE
+
+constexpr int prioritized_queue::default_urgency;
+
+class prioritized_queue_operation
+  : public operation
+  , public std::enable_shared_from_this<prioritized_queue_operation>
+{
+public:
+    explicit prioritized_queue_operation(const queue& inner_queue)
+      : m_inner_queue(inner_queue)
+      , m_CS()
+      , m_operations()
+      , m_sequence(0)
+      , m_scheduled(false)
+    {}
+
+    void operator()() override
+    {
+        // pass another drain to the inner queue once a bounded number
+        // of operations was executed or one of them threw, so that
+        // other work on the inner queue is not starved
+        struct yield_scope
+        {
+            prioritized_queue_operation* m_owner;
+            bool m_active;
+
+            ~yield_scope()
+            {
+                if (m_active) {
+                    m_owner->m_inner_queue.async(m_owner->shared_from_this());
+                }
+            }
+        } yield{ this, true };
+
+        static constexpr int kMaxOpsPerDrain = 10;
+        for (int i = 0; i < kMaxOpsPerDrain; ++i) {
+            operation_ptr op;
+            {
+                std::lock_guard<std::mutex> lock(m_CS);
+                if (m_operations.empty()) {
+                    m_scheduled = false;
+                    yield.m_active = false;
+                    return;
+                }
+                // the heap only hands out const references, the entry
+                // is removed right away so moving the operation is safe
+                op = std::move(const_cast<entry&>(m_operations.top()).m_op);
+                m_operations.pop();
+            }
+            execute_operation_on_this_thread(*op);
+        }
+    }
+
+    void add_one(int urgency, const operation_ptr& op)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_CS);
+            m_operations.push(entry{ urgency, m_sequence++, op });
+            if (m_scheduled) {
+                // the pending drain picks up this operation as well
+                return;
+            }
+            m_scheduled = true;
+        }
+        m_inner_queue.async(shared_from_this());
+    }
+
+    size_t depth()
+    {
+        std::lock_guard<std::mutex> lock(m_CS);
+        return m_operations.size();
+    }
+
+private:
+    struct entry
+    {
+        int m_urgency;
+        std::uint64_t m_sequence;
+        operation_ptr m_op;
+
+        // the heap keeps the largest entry on top, i.e. the one with the
+        // highest urgency and among those the one queued first
+        bool operator<(const entry& other) const
+        {
+            if (m_urgency != other.m_urgency) {
+                return m_urgency < other.m_urgency;
+            }
+            return m_sequence > other.m_sequence;
+        }
+    };
+
+    const queue m_inner_queue;
+    std::mutex m_CS;
+    std::priority_queue<entry, std::vector<entry>> m_operations;
+    std::uint64_t m_sequence;
+    // set while a drain is queued on the inner queue, protected by m_CS
+    bool m_scheduled;
+};
+
+class prioritized_queue::impl
+  : public std::enable_shared_from_this<prioritized_queue::impl>
+  , public iqueue_impl
+{
+public:
+    impl(const queue& inner_queue)
+      : m_worker(std::make_shared<prioritized_queue_operation>(inner_queue))
+      , m_inner_queue(inner_queue)
+    {}
+
+    size_t depth() { return m_worker->depth(); }
+
+    void async(int urgency, const operation_ptr& op)
+    {
+        // the drain picks whichever operation is the most urgent
+        // at the time it executes, not necessarily this one
+        m_worker->add_one(urgency, op);
+    }
+
+    void async(const operation_ptr& op) override
+    {
+        async(prioritized_queue::default_urgency, op);
+    }
+
+    void barrier_async(const operation_ptr& op) override
+    {
+        m_inner_queue.barrier_async(op);
+    }
+
+    void sync(const operation_ptr& op) override { m_inner_queue.sync(op); }
+
+    void apply(size_t times, const iteration_operation_ptr& op) override
+    {
+        m_inner_queue.apply(times, op);
+    }
+
+    void after(std::chrono::milliseconds delay,
+               const operation_ptr& op) override
+    {
+        auto timer =
+          backend_for_type(backend()).create_timer(shared_from_this());
+        timer->handler(make_operation([op, timer] {
+            execute_operation_on_this_thread(*op);
+            timer->cancel();
+        }));
+        timer->resume(delay);
+    }
+
+    backend_type backend() override
+    {
+        return m_inner_queue.implementation()->backend();
+    }
+
+    queue_priority priority() override
+    {
+        return m_inner_queue.implementation()->priority();
+    }
+
+    void boost(queue_priority priority) override
+    {
+        m_inner_queue.implementation()->boost(priority);
+    }
+
+private:
+    std::shared_ptr<prioritized_queue_operation> m_worker;
+    queue m_inner_queue;
+};
+
+prioritized_queue::prioritized_queue(const std::string& label,
+                                     queue_priority priority)
+  : prioritized_queue(label, queue(label, priority))
+{}
+
+prioritized_queue::prioritized_queue(const std::string& label,
+                                     const queue& inner_queue)
+  : queue(label, std::make_shared<impl>(inner_queue))
+{}
+
+void
+prioritized_queue::async(int urgency, const operation_ptr& op) const
+{
+    XDISPATCH_ASSERT(op);
+    const auto q_impl = implementation();
+    queue_operation_with_d(*op, q_impl.get());
+    std::static_pointer_cast<impl>(q_impl)->async(urgency, op);
+}
+
+size_t
+prioritized_queue::depth() const
+{
+    const auto inner = std::static_pointer_cast<impl>(implementation());
+    return inner->depth();
+}
@@ -68,6 +68,7 @@ ThreadPoolProxy::execute(const operation_ptr& work,
     int p = 0;
     switch (priority) {
         case queue_priority::BACKGROUND:
+        case queue_priority::IDLE:
             p = 0; // NOLINT(readability-magic-numbers)
             break;
         case queue_priority::DEFAULT:
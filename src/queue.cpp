@@ -21,9 +21,169 @@
 
 #include "xdispatch_internal.h"
 #include "xdispatch/impl/iqueue_impl.h"
+#include "trace_utils.h"
 
 __XDISPATCH_USE_NAMESPACE
 
+namespace {
+
+// a function object so that it can be stored inline
+class deadline_call
+{
+public:
+    deadline_call(const operation_ptr& op,
+                  std::chrono::steady_clock::time_point deadline,
+                  const iqueue_impl_ptr& q_impl)
+      : m_op(op)
+      , m_deadline(deadline)
+      , m_q_impl(q_impl)
+    {}
+
+    void operator()() const { run(); }
+
+    // returns false if the deadline passed and the operation was dropped
+    bool run() const
+    {
+        if (std::chrono::steady_clock::now() <= m_deadline) {
+            execute_operation_on_this_thread(*m_op);
+            return true;
+        }
+
+        XDISPATCH_TRACE() << "Deadline passed, dropping operation";
+        m_q_impl->count_expired();
+        return false;
+    }
+
+private:
+    operation_ptr m_op;
+    std::chrono::steady_clock::time_point m_deadline;
+    iqueue_impl_ptr m_q_impl;
+};
+static_assert(inline_operation::fits_inline<deadline_call>::value,
+              "Deadline calls are expected to be stored inline");
+
+// exceeds the inline capacity, only used if a handler was given
+class expiring_deadline_call
+{
+public:
+    expiring_deadline_call(const deadline_call& call,
+                           const operation_ptr& on_expired)
+      : m_call(call)
+      , m_on_expired(on_expired)
+    {}
+
+    void operator()() const
+    {
+        if (!m_call.run()) {
+            execute_operation_on_this_thread(*m_on_expired);
+        }
+    }
+
+private:
+    deadline_call m_call;
+    operation_ptr m_on_expired;
+};
+
+// a function object so that it can be stored inline
+class cancellable_call
+{
+public:
+    cancellable_call(const operation_ptr& op, const cancellation_token& token)
+      : m_op(op)
+      , m_token(token)
+    {}
+
+    void operator()() const
+    {
+        if (m_token.is_cancelled()) {
+            XDISPATCH_TRACE() << "Token cancelled, skipping operation";
+            return;
+        }
+        execute_operation_on_this_thread(*m_op);
+    }
+
+private:
+    operation_ptr m_op;
+    cancellation_token m_token;
+};
+
+} // namespace
+
+static thread_local iqueue_impl* s_executing_queue = nullptr;
+
+executing_queue_scope::executing_queue_scope(iqueue_impl* q_impl)
+  : m_previous(s_executing_queue)
+{
+    s_executing_queue = q_impl;
+}
+
+executing_queue_scope::~executing_queue_scope()
+{
+    s_executing_queue = m_previous;
+}
+
+iqueue_impl*
+executing_queue_scope::current()
+{
+    return s_executing_queue;
+}
+
+static int
+priority_rank(queue_priority priority)
+{
+    switch (priority) {
+        case queue_priority::USER_INTERACTIVE:
+            return 4;
+        case queue_priority::USER_INITIATED:
+            return 3;
+        case queue_priority::DEFAULT:
+        case queue_priority::UTILITY:
+            return 2;
+        case queue_priority::BACKGROUND:
+            return 1;
+        case queue_priority::IDLE:
+            return 0;
+    }
+    return 0;
+}
+
+bool
+xdispatch::is_more_urgent(queue_priority a, queue_priority b)
+{
+    return priority_rank(a) > priority_rank(b);
+}
+
+queue_priority
+xdispatch::inherit_priority(queue_priority priority)
+{
+    if (queue_priority::DEFAULT != priority) {
+        return priority;
+    }
+    auto* const current = executing_queue_scope::current();
+    return current ? current->priority() : priority;
+}
+
+inline_operation
+xdispatch::make_deadline_operation(
+  const operation_ptr& op,
+  std::chrono::steady_clock::time_point deadline,
+  const operation_ptr& on_expired,
+  const iqueue_impl_ptr& q_impl)
+{
+    const deadline_call call(op, deadline, q_impl);
+    if (!on_expired) {
+        return inline_operation::make(call);
+    }
+    return inline_operation::make(expiring_deadline_call(call, on_expired));
+}
+
+operation_ptr
+xdispatch::make_cancellable_operation(const operation_ptr& op,
+                                      const cancellation_token& token)
+{
+    return make_operation(cancellable_call(op, token));
+}
+
 queue::queue(const std::string& label, const iqueue_impl_ptr& impl)
   : m_impl(impl)
   , m_label(label)
@@ -36,7 +196,65 @@ queue::async(const operation_ptr& op) const
 {
     XDISPATCH_ASSERT(op);
     queue_operation_with_d(*op, m_impl.get());
-    m_impl->async(op);
+    if (!batch_async(m_impl, op)) {
+        m_impl->async(op);
+    }
+}
+
+void
+queue::async(inline_operation&& op) const
+{
+    XDISPATCH_ASSERT(op);
+    if (!batch_async(m_impl, op)) {
+        m_impl->async_inline(std::move(op));
+    }
+}
+
+void
+queue::async(const operation_ptr& op,
+             std::chrono::steady_clock::time_point deadline,
+             const operation_ptr& on_expired) const
+{
+    XDISPATCH_ASSERT(op);
+    queue_operation_with_d(*op, m_impl.get());
+    async(make_deadline_operation(op, deadline, on_expired, m_impl));
+}
+
+void
+queue::async(const operation_ptr& op, const cancellation_token& token) const
+{
+    XDISPATCH_ASSERT(op);
+    queue_operation_with_d(*op, m_impl.get());
+    async(inline_operation::make(cancellable_call(op, token)));
+}
+
+bool
+queue::try_async(const operation_ptr& op) const
+{
+    XDISPATCH_ASSERT(op);
+    queue_operation_with_d(*op, m_impl.get());
+    flush_batch(m_impl.get());
+    return m_impl->try_async(op);
+}
+
+void
+queue::barrier_async(const operation_ptr& op) const
+{
+    XDISPATCH_ASSERT(op);
+    queue_operation_with_d(*op, m_impl.get());
+    flush_batch(m_impl.get());
+    m_impl->barrier_async(op);
+}
+
+void
+queue::sync(const operation_ptr& op) const
+{
+    XDISPATCH_ASSERT(op);
+    queue_operation_with_d(*op, m_impl.get());
+    flush_batch(m_impl.get());
+    // the operation may be executed on this thread
+    suspended_batch_scope suspended;
+    m_impl->sync(op);
 }
 
 void
@@ -44,9 +262,27 @@ queue::apply(size_t times, const iteration_operation_ptr& op) const
 {
     XDISPATCH_ASSERT(op);
     queue_operation_with_d(*op, m_impl.get());
+    flush_batch(m_impl.get());
+    // iterations may be executed on this thread
+    suspended_batch_scope suspended;
     m_impl->apply(times, op);
 }
 
+void
+queue::apply(size_t times,
+             const iteration_operation_ptr& op,
+             const cancellation_token& token) const
+{
+    XDISPATCH_ASSERT(op);
+    // the token is tested by every iteration so that all iterations not
+    // started yet are skipped once it gets cancelled
+    apply(times, make_iteration_operation([op, token](size_t index) {
+              if (!token.is_cancelled()) {
+                  execute_operation_on_this_thread(*op, index);
+              }
+          }));
+}
+
 void
 queue::after(std::chrono::milliseconds delay, const operation_ptr& op) const
 {
@@ -60,6 +296,43 @@ queue::label() const
     return m_label;
 }
 
+queue_priority
+queue::priority() const
+{
+    return m_impl->priority();
+}
+
+size_t
+queue::expired() const
+{
+    return m_impl->expired();
+}
+
+void
+queue::set_specific(const void* key, void* value) const
+{
+    m_impl->set_specific(key, value);
+}
+
+void*
+queue::get_specific(const void* key) const
+{
+    return m_impl->get_specific(key);
+}
+
+void*
+queue::current_specific(const void* key)
+{
+    auto* const current = executing_queue_scope::current();
+    return current ? current->get_specific(key) : nullptr;
+}
+
+bool
+queue::is_current() const
+{
+    return executing_queue_scope::current() == m_impl.get();
+}
+
 bool
 queue::operator==(const queue& other) const
 {
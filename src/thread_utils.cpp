@@ -175,6 +175,7 @@ thread_utils::map_priority_to_qos(queue_priority priority)
             qos_class = QOS_CLASS_DEFAULT;
             break;
         case queue_priority::BACKGROUND:
+        case queue_priority::IDLE:
             qos_class = QOS_CLASS_BACKGROUND;
             break;
     }
@@ -203,6 +204,7 @@ thread_utils::map_priority_to_nice(queue_priority priority)
             nice = sNiceBase + 1;
             break;
         case queue_priority::BACKGROUND:
+        case queue_priority::IDLE:
             nice = sNiceBase + 2;
             break;
     }
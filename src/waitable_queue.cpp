@@ -136,9 +136,17 @@ public:
       , m_inner_queue(inner_queue)
     {}
 
-    void wait_for_one() { m_worker->wait_for_one(); }
+    void wait_for_one()
+    {
+        boost(inherit_priority(queue_priority::DEFAULT));
+        m_worker->wait_for_one();
+    }
 
-    void wait_for_all() { m_worker->wait_for_all(); }
+    void wait_for_all()
+    {
+        boost(inherit_priority(queue_priority::DEFAULT));
+        m_worker->wait_for_all();
+    }
 
     void async(const operation_ptr& op) override
     {
@@ -171,6 +179,16 @@ public:
         return m_inner_queue.implementation()->backend();
     }
 
+    queue_priority priority() override
+    {
+        return m_inner_queue.implementation()->priority();
+    }
+
+    void boost(queue_priority priority) override
+    {
+        m_inner_queue.implementation()->boost(priority);
+    }
+
 private:
     std::shared_ptr<waitable_queue_operation> m_worker;
     queue m_inner_queue;
@@ -59,9 +59,11 @@ constexpr const char k_label_global_INITIATED[] =
 constexpr const char k_label_global_UTILITY[] = "de.emzeat.xdispatch2.utility";
 constexpr const char k_label_global_BACKGROUND[] =
   "de.emzeat.xdispatch2.background";
+constexpr const char k_label_global_IDLE[] = "de.emzeat.xdispatch2.idle";
 
 #include "xdispatch/config.h"
 #include "../include/xdispatch/operation.h"
+#include "../include/xdispatch/cancellation.h"
 #include "../include/xdispatch/queue.h"
 #include "../include/xdispatch/backend.h"
 #include "../include/xdispatch/group.h"
@@ -79,6 +81,122 @@ execute_operation_on_this_thread(operation&);
 ibackend&
 backend_for_type(backend_type type);
 
+/**
+  Marks the given queue as executing operations on the calling thread
+  for as long as the scope is alive, see queue::is_current()
+  */
+class executing_queue_scope
+{
+public:
+    explicit executing_queue_scope(iqueue_impl* q_impl);
+    executing_queue_scope(const executing_queue_scope&) = delete;
+
+    ~executing_queue_scope();
+
+    /**
+      @returns the queue executing operations on the calling thread
+      */
+    static iqueue_impl* current();
+
+private:
+    iqueue_impl* const m_previous;
+};
+
+/**
+  @returns true if work of priority a is to be preferred over work of b
+  */
+bool
+is_more_urgent(queue_priority a, queue_priority b);
+
+/**
+  @returns the priority to use for work submitted with the given priority
+
+  Work without an explicit priority inherits the priority of the queue
+  executing the submitting code, if known, so that chains of operations
+  keep their priority.
+  */
+queue_priority
+inherit_priority(queue_priority priority);
+
+/**
+  Wraps the given operation so that it will be dropped and counted
+  on the given queue if its execution starts after the deadline. The
+  wrapper is stored inline unless an on_expired operation is given
+  */
+inline_operation
+make_deadline_operation(const operation_ptr& op,
+                        std::chrono::steady_clock::time_point deadline,
+                        const operation_ptr& on_expired,
+                        const iqueue_impl_ptr& q_impl);
+
+/**
+  Wraps the given operation so that it will be skipped without being
+  invoked once the token was cancelled
+  */
+operation_ptr
+make_cancellable_operation(const operation_ptr& op,
+                           const cancellation_token& token);
+
+class batch_scope;
+class lightweight_barrier;
+
+/**
+  Waits for the barrier to complete or the timeout to pass
+
+  When invoked on a thread of a threadpool supporting it, operations
+  pending on the pool are executed while waiting, see
+  naive::ithreadpool::help_current(). Only once there is nothing to help
+  with, the thread blocks and the pool is notified accordingly.
+
+  @returns true if the barrier completed before the timeout passed
+  */
+bool
+wait_helping(lightweight_barrier& barrier,
+             std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+
+/**
+  Suspends the batch_scope active on the calling thread for as long as
+  the scope is alive, so that operations executed by a blocking call
+  submit directly instead of to a batch flushed only after they finished
+  */
+class suspended_batch_scope
+{
+public:
+    suspended_batch_scope();
+    suspended_batch_scope(const suspended_batch_scope&) = delete;
+
+    ~suspended_batch_scope();
+
+private:
+    batch_scope* const m_suspended;
+};
+
+/**
+  Buffers the given operation in the batch_scope active on this thread
+
+  @returns false if there is no active scope and the operation needs
+           to be passed to the queue directly
+  */
+bool
+batch_async(const iqueue_impl_ptr& q_impl, const operation_ptr& op);
+
+/**
+  @see batch_async(const iqueue_impl_ptr&, const operation_ptr&)
+
+  The operation is only taken if it was buffered
+  */
+bool
+batch_async(const iqueue_impl_ptr& q_impl, inline_operation& op);
+
+/**
+  Passes all operations buffered for the given queue in the batch_scope
+  active on this thread to the queue, to be invoked before submitting
+  to the queue by any other means
+  */
+void
+flush_batch(const iqueue_impl* q_impl);
+
 __XDISPATCH_END_NAMESPACE
 
 #undef __XDISPATCH_INDIRECT__
@@ -0,0 +1,110 @@
+/*
+ * cxx_batch_scope.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <atomic>
+#include <thread>
+
+#include <xdispatch/batch_scope.h>
+
+#include "cxx_tests.h"
+
+static void
+wait_for(const std::atomic<int>& executed, int expected)
+{
+    const auto timeout =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (executed < expected && std::chrono::steady_clock::now() < timeout) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    MU_ASSERT_EQUAL(executed, expected);
+}
+
+void
+cxx_batch_scope(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_batch_scope);
+
+    const auto queue = cxx_create_queue("cxx_batch_scope");
+    auto executed = std::make_shared<std::atomic<int>>(0);
+
+    {
+        xdispatch::batch_scope batch;
+        for (int i = 0; i < 10; ++i) {
+            queue.async([executed, i] {
+                // operations are passed on in order
+                MU_ASSERT_EQUAL(*executed, i);
+                ++(*executed);
+            });
+        }
+        {
+            // joins the outer scope
+            xdispatch::batch_scope nested(1);
+            queue.async([executed] { ++(*executed); });
+        }
+        // nothing has been passed to the queue yet
+        MU_ASSERT_EQUAL(*executed, 0);
+
+        // all buffered operations run before the synchronous one
+        queue.sync([executed] { MU_ASSERT_EQUAL(*executed, 11); });
+        MU_ASSERT_EQUAL(*executed, 11);
+
+        queue.async([executed] { ++(*executed); });
+    }
+
+    {
+        // reaching the threshold passes the operations on
+        xdispatch::batch_scope batch(2);
+        queue.async([executed] { ++(*executed); });
+        queue.async([executed] { ++(*executed); });
+        wait_for(*executed, 14);
+    }
+
+    {
+        // operations executed on this thread are not batched
+        xdispatch::batch_scope batch;
+        const auto other = cxx_create_queue("cxx_batch_scope.other");
+        queue.sync([executed, other] {
+            other.async([executed] { ++(*executed); });
+            wait_for(*executed, 15);
+        });
+    }
+
+    {
+        // a nested scope flushed while suspended leaves the batches of
+        // the outer scope alone
+        xdispatch::batch_scope batch;
+        xdispatch::batch_scope nested;
+        const auto other = cxx_create_queue("cxx_batch_scope.nested");
+        other.async([executed] { ++(*executed); });
+        queue.sync([&nested] { nested.flush(); });
+        MU_ASSERT_EQUAL(*executed, 15);
+    }
+    wait_for(*executed, 16);
+
+    queue.async([executed] {
+        MU_ASSERT_EQUAL(*executed, 16);
+        MU_PASS("Completed");
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
@@ -22,12 +22,98 @@
 
 #include <xdispatch/dispatch>
 #include <xdispatch/barrier_operation.h>
+#include <xdispatch/typed_queue.h>
+#include <xdispatch/impl/cancelable.h>
+#include <xdispatch/impl/lightweight_barrier.h>
 #include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
 
 #include "cxx_tests.h"
 #include "stopwatch.h"
 
 constexpr int kCOUNT = 100000;
+constexpr int kQUEUES = 1000000;
+
+// counts the allocations and bytes allocated via operator new while
+// enabled so that the memory footprint of objects created by the library
+// can be determined. The bytes currently allocated are tracked at all
+// times so that memory kept occupied can be determined as well.
+// Allocations made from within a shared library on Windows are not seen.
+static std::atomic<bool> s_count_allocations(false);
+static std::atomic<size_t> s_allocations(0);
+static std::atomic<size_t> s_allocated_bytes(0);
+static std::atomic<size_t> s_live_bytes(0);
+
+// every allocation is prefixed with its size, keeping the alignment
+static constexpr std::size_t kHEADER = alignof(std::max_align_t);
+
+void*
+operator new(std::size_t size)
+{
+    if (s_count_allocations.load(std::memory_order_relaxed)) {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        s_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    auto* const ptr = static_cast<char*>(std::malloc(kHEADER + size));
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<std::size_t*>(ptr) = size;
+    s_live_bytes.fetch_add(size, std::memory_order_relaxed);
+    return ptr + kHEADER;
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    if (!ptr) {
+        return;
+    }
+    auto* const header = static_cast<char*>(ptr) - kHEADER;
+    s_live_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(header),
+                           std::memory_order_relaxed);
+    std::free(header);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+// runs the given loop of count iterations while counting allocations
+// and reports the time and allocations per iteration, e.g. as
+// "Waited 10 times, 5 nsec and 0.00 allocations per wait"
+template<typename Loop>
+static void
+measure_allocations(const char* action,
+                    int count,
+                    const char* items,
+                    const char* item,
+                    Loop&& loop)
+{
+    Stopwatch watch;
+    s_allocations = 0;
+    s_count_allocations = true;
+    watch.start();
+    loop();
+    watch.stop();
+    s_count_allocations = false;
+
+    const auto allocations = static_cast<int>(s_allocations * 100 / count);
+    MU_MESSAGE("%s %i %s, %i nsec and %i.%02i allocations per %s",
+               action,
+               count,
+               items,
+               static_cast<int>(watch.elapsed().count() * 1000 / count),
+               allocations / 100,
+               allocations % 100,
+               item);
+}
 
 template<class receiver>
 void
@@ -96,23 +182,20 @@ cxx_benchmark_group(void* data)
     auto queue = cxx_global_queue();
 
     Stopwatch watch_execution;
-    Stopwatch watch_dispatch;
     std::atomic<int> passes(0);
 
     // begin measurement
     watch_execution.start();
-    watch_dispatch.start();
 
     // schedule kCOUNT empty lambda blocks to measure the overhead
     // spent on scheduling the given queue
     auto work = xdispatch::make_operation([&passes] { ++passes; });
-    for (int i = 0; i < kCOUNT; ++i) {
-        group.async(work, queue);
-    }
-    watch_dispatch.stop();
-    MU_MESSAGE("Dispatched %i operations, %i nsec per operation",
-               kCOUNT,
-               watch_dispatch.elapsed() * 1000 / kCOUNT);
+    measure_allocations(
+      "Dispatched", kCOUNT, "operations", "operation", [&] {
+          for (int i = 0; i < kCOUNT; ++i) {
+              group.async(work, queue);
+          }
+      });
 
     // notify on completion
     group.notify(
@@ -131,3 +214,200 @@ cxx_benchmark_group(void* data)
     MU_FAIL("Should never reach this");
     MU_END_TEST;
 }
+
+void
+cxx_benchmark_queue_lifecycle(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_benchmark_queue_lifecycle);
+
+    std::vector<xdispatch::queue> queues;
+    queues.reserve(kQUEUES);
+    Stopwatch watch;
+
+    // create
+    const size_t live_before = s_live_bytes;
+    s_allocated_bytes = 0;
+    s_count_allocations = true;
+    watch.start();
+    for (int i = 0; i < kQUEUES; ++i) {
+        queues.push_back(cxx_create_queue("lifecycle"));
+    }
+    watch.stop();
+    s_count_allocations = false;
+    MU_MESSAGE("Created %i queues, %i nsec and %i bytes per queue",
+               kQUEUES,
+               static_cast<int>(watch.elapsed().count() * 1000 / kQUEUES),
+               static_cast<int>(s_allocated_bytes / kQUEUES));
+
+    // use
+    std::atomic<int> passes(0);
+    auto work = xdispatch::make_operation([&passes] { ++passes; });
+    watch.start();
+    for (const auto& queue : queues) {
+        queue.async(work);
+    }
+    while (passes < kQUEUES) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    watch.stop();
+    MU_MESSAGE("Executed %i operations, %i nsec per queue",
+               kQUEUES,
+               static_cast<int>(watch.elapsed().count() * 1000 / kQUEUES));
+
+    // the last operations may still be completing, their queues only
+    // release any memory once they are done
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const size_t live_after = s_live_bytes;
+    MU_MESSAGE("Used queues occupy %i bytes per queue",
+               static_cast<int>((live_after - live_before) / kQUEUES));
+
+    // destroy
+    watch.start();
+    queues.clear();
+    watch.stop();
+    MU_MESSAGE("Destroyed %i queues, %i nsec per queue",
+               kQUEUES,
+               static_cast<int>(watch.elapsed().count() * 1000 / kQUEUES));
+
+    MU_PASS("Test completed");
+    MU_END_TEST;
+}
+
+static void
+do_lambda_benchmark(const xdispatch::queue& queue)
+{
+    std::atomic<int> passes(0);
+
+    // dispatch small lambdas the way most code does, including the
+    // allocations made while executing them
+    measure_allocations("Dispatched", kCOUNT, "lambdas", "operation", [&] {
+        for (int i = 0; i < kCOUNT; ++i) {
+            queue.async([&passes] { ++passes; });
+        }
+        while (passes < kCOUNT) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    // a single lambda at a time, so that the queue drains and is woken
+    // up again for every operation. Run once before measuring so that
+    // the caches of the recycled buffers are filled already
+    constexpr int kROUNDTRIPS = kCOUNT / 10;
+    const auto roundtrips = [&] {
+        for (int i = 0; i < kROUNDTRIPS; ++i) {
+            xdispatch::lightweight_barrier barrier;
+            queue.async([&barrier] { barrier.complete(); });
+            MU_ASSERT_TRUE(barrier.wait());
+        }
+    };
+    roundtrips();
+    measure_allocations(
+      "Dispatched", kROUNDTRIPS, "single lambdas", "operation", roundtrips);
+}
+
+void
+cxx_benchmark_lambda_dispatch(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_benchmark_lambda_dispatch);
+
+    MU_MESSAGE("Serial queue:");
+    do_lambda_benchmark(cxx_create_queue("cxx_benchmark_lambda_dispatch"));
+    MU_MESSAGE("Global queue:");
+    do_lambda_benchmark(cxx_global_queue());
+
+    MU_PASS("Test completed");
+    MU_END_TEST;
+}
+
+void
+cxx_benchmark_typed_queue(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_benchmark_typed_queue);
+
+    std::atomic<int> passes(0);
+    const auto worker = xdispatch::make_typed_worker<int>(
+      cxx_create_queue("cxx_benchmark_typed_queue"),
+      [&passes](int value) { passes += value; },
+      kCOUNT);
+
+    // the same stream as do_lambda_benchmark, but as plain messages
+    measure_allocations("Dispatched", kCOUNT, "messages", "message", [&] {
+        for (int i = 0; i < kCOUNT; ++i) {
+            worker.async(1);
+        }
+        while (passes < kCOUNT) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    MU_PASS("Test completed");
+    MU_END_TEST;
+}
+
+void
+cxx_benchmark_cancelable_scope(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_benchmark_cancelable_scope);
+
+    xdispatch::cancelable cancelable;
+    int passes = 0;
+
+    // entered on every timer tick, notifier event and signal handler call
+    measure_allocations("Entered", kCOUNT, "scopes", "scope", [&] {
+        for (int i = 0; i < kCOUNT; ++i) {
+            xdispatch::cancelable_scope scope(cancelable);
+            if (scope) {
+                ++passes;
+            }
+        }
+    });
+    MU_ASSERT_EQUAL(passes, kCOUNT);
+
+    MU_PASS("Test completed");
+    MU_END_TEST;
+}
+
+void
+cxx_benchmark_lightweight_barrier(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_benchmark_lightweight_barrier);
+
+    constexpr int kWAITS = kCOUNT / 10;
+    auto queue = cxx_global_queue();
+
+    // every wait is likely to block as the barrier is completed by
+    // another thread, the way timer ticks and sync() use barriers
+    measure_allocations("Waited", kWAITS, "times", "wait", [&] {
+        for (int i = 0; i < kWAITS; ++i) {
+            xdispatch::lightweight_barrier barrier;
+            queue.async([&barrier] { barrier.complete(); });
+            MU_ASSERT_TRUE(barrier.wait());
+        }
+    });
+
+    MU_PASS("Test completed");
+    MU_END_TEST;
+}
+
+void
+cxx_benchmark_group_wait(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_benchmark_group_wait);
+
+    constexpr int kWAITS = kCOUNT / 10;
+    auto group = cxx_create_group();
+    auto queue = cxx_global_queue();
+    auto work = xdispatch::make_operation([] {});
+
+    // a fork/join cycle of a single operation, the group drains and
+    // is reused in between
+    measure_allocations("Waited", kWAITS, "times", "wait", [&] {
+        for (int i = 0; i < kWAITS; ++i) {
+            group.async(work, queue);
+            MU_ASSERT_TRUE(group.wait());
+        }
+    });
+
+    MU_PASS("Test completed");
+    MU_END_TEST;
+}
@@ -0,0 +1,201 @@
+/*
+ * cxx_bounded_queue.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <list>
+#include <vector>
+
+#include <xdispatch/bounded_queue.h>
+#include <xdispatch/impl/iqueue_impl.h>
+#include "cxx_tests.h"
+
+namespace {
+
+class manual_queue_impl : public xdispatch::iqueue_impl
+{
+public:
+    void async(const xdispatch::operation_ptr& op) override
+    {
+        m_ops.push_back(op);
+    }
+    void apply(size_t, const xdispatch::iteration_operation_ptr&) override
+    {
+        MU_FAIL("Not implemented for this test");
+    }
+    void after(std::chrono::milliseconds,
+               const xdispatch::operation_ptr&) override
+    {
+        MU_FAIL("Not implemented for this test");
+    }
+    xdispatch::backend_type backend() override
+    {
+        return static_cast<xdispatch::backend_type>(
+          static_cast<int>(xdispatch::backend_type::naive) + 10);
+    }
+
+    void drain_all()
+    {
+        while (!m_ops.empty()) {
+            auto op = m_ops.front();
+            m_ops.pop_front();
+            xdispatch::execute_operation_on_this_thread(*op);
+        }
+    }
+
+private:
+    std::list<xdispatch::operation_ptr> m_ops;
+};
+
+class manual_queue : public xdispatch::queue
+{
+public:
+    manual_queue(const std::string& label)
+      : xdispatch::queue(label, std::make_shared<manual_queue_impl>())
+    {}
+
+    void drain_all()
+    {
+        const auto inner =
+          std::static_pointer_cast<manual_queue_impl>(implementation());
+        return inner->drain_all();
+    }
+};
+
+std::vector<int>
+fill_and_drain(xdispatch::overflow_policy policy)
+{
+    manual_queue inner("cxx_bounded_queue.inner");
+    xdispatch::bounded_queue bounded(
+      "cxx_bounded_queue.outer", inner, 2, policy);
+
+    std::vector<int> executed;
+    for (int i = 1; i <= 3; ++i) {
+        bounded.async([&executed, i] { executed.push_back(i); });
+    }
+    MU_ASSERT_EQUAL(bounded.depth(), 2);
+    MU_ASSERT_EQUAL(bounded.dropped(), 1);
+    inner.drain_all();
+    MU_ASSERT_EQUAL(bounded.depth(), 0);
+    return executed;
+}
+
+} // namespace
+
+void
+cxx_bounded_queue(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_bounded_queue);
+
+    // a full queue refuses new operations
+    {
+        manual_queue inner("cxx_bounded_queue.inner");
+        xdispatch::bounded_queue bounded("cxx_bounded_queue.outer",
+                                         inner,
+                                         2,
+                                         xdispatch::overflow_policy::reject);
+
+        int executed = 0;
+        MU_ASSERT_TRUE(bounded.try_async([&] { ++executed; }));
+        MU_ASSERT_TRUE(bounded.try_async([&] { ++executed; }));
+        MU_ASSERT_TRUE(!bounded.try_async([&] { ++executed; }));
+        MU_ASSERT_EQUAL(bounded.dropped(), 0);
+        bounded.async([&] { ++executed; });
+        MU_ASSERT_EQUAL(bounded.dropped(), 1);
+        inner.drain_all();
+        MU_ASSERT_EQUAL(executed, 2);
+        MU_ASSERT_TRUE(bounded.try_async([&] { ++executed; }));
+        inner.drain_all();
+        MU_ASSERT_EQUAL(executed, 3);
+    }
+
+    // a blocking queue refuses operations passed via try_async
+    {
+        manual_queue inner("cxx_bounded_queue.inner");
+        xdispatch::bounded_queue bounded("cxx_bounded_queue.outer",
+                                         inner,
+                                         1,
+                                         xdispatch::overflow_policy::block);
+
+        MU_ASSERT_TRUE(bounded.try_async([] {}));
+        MU_ASSERT_TRUE(!bounded.try_async([] {}));
+        inner.drain_all();
+        MU_ASSERT_TRUE(bounded.try_async([] {}));
+        inner.drain_all();
+    }
+
+    // discarding operations keeps the order of the remaining ones
+    const auto oldest = fill_and_drain(xdispatch::overflow_policy::drop_oldest);
+    MU_ASSERT_EQUAL(oldest.size(), 2);
+    MU_ASSERT_EQUAL(oldest[0], 2);
+    MU_ASSERT_EQUAL(oldest[1], 3);
+    const auto newest = fill_and_drain(xdispatch::overflow_policy::drop_newest);
+    MU_ASSERT_EQUAL(newest.size(), 2);
+    MU_ASSERT_EQUAL(newest[0], 1);
+    MU_ASSERT_EQUAL(newest[1], 3);
+
+    // watermarks are signaled once per crossing
+    {
+        manual_queue inner("cxx_bounded_queue.inner");
+        xdispatch::bounded_queue bounded("cxx_bounded_queue.outer", inner, 10);
+
+        int high = 0;
+        int low = 0;
+        bounded.on_high_watermark(3, [&] { ++high; });
+        bounded.on_low_watermark(1, [&] { ++low; });
+        for (int i = 0; i < 5; ++i) {
+            bounded.async([] {});
+        }
+        MU_ASSERT_EQUAL(high, 1);
+        MU_ASSERT_EQUAL(low, 0);
+        inner.drain_all();
+        MU_ASSERT_EQUAL(high, 1);
+        MU_ASSERT_EQUAL(low, 1);
+    }
+
+#if (defined BUILD_XDISPATCH2_BACKEND_LIBDISPATCH)
+    if (xdispatch::backend_type::libdispatch ==
+        cxx_global_queue().implementation()->backend()) {
+        MU_PASS("Executing queue only reported by naive based backends");
+    }
+#endif
+
+    // operations executed by the inner queue cannot wait for room
+    {
+        const auto inner = cxx_create_queue("cxx_bounded_queue.inner");
+        xdispatch::bounded_queue bounded("cxx_bounded_queue.outer",
+                                         inner,
+                                         1,
+                                         xdispatch::overflow_policy::block);
+
+        int executed = 0;
+        bounded.async([&] {
+            bounded.async([&] { ++executed; });
+            bounded.async([&] { ++executed; });
+        });
+        // the second sync is queued after the nested operations
+        inner.sync([] {});
+        inner.sync([] {});
+        MU_ASSERT_EQUAL(executed, 1);
+        MU_ASSERT_EQUAL(bounded.dropped(), 1);
+    }
+
+    MU_PASS("Completed");
+    MU_END_TEST;
+}
@@ -0,0 +1,80 @@
+/*
+ * cxx_cancellation.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <xdispatch/dispatch>
+#include "cxx_tests.h"
+
+#include <thread>
+
+constexpr int kOPERATIONS = 100;
+
+void
+cxx_cancellation(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_cancellation);
+
+    const auto queue = cxx_create_queue("cxx_cancellation");
+    xdispatch::cancellation_source source;
+    const auto token = source.token();
+    MU_ASSERT_TRUE(token.can_be_cancelled());
+    MU_ASSERT_TRUE(!token.is_cancelled());
+    MU_ASSERT_TRUE(!xdispatch::cancellation_token().can_be_cancelled());
+
+    // hold back the queue until all operations were cancelled
+    std::atomic<bool> released(false);
+    queue.async([&released] {
+        while (!released) {
+            std::this_thread::yield();
+        }
+    });
+
+    std::atomic<int> executed(0);
+    auto group = cxx_create_group();
+    for (int i = 0; i < kOPERATIONS; ++i) {
+        queue.async([&executed] { ++executed; }, token);
+        group.async([&executed] { ++executed; }, queue, token);
+    }
+    queue.async([&executed] { ++executed; });
+    source.cancel();
+    MU_ASSERT_TRUE(source.is_cancelled());
+    MU_ASSERT_TRUE(token.is_cancelled());
+    released = true;
+
+    // skipped operations count as completed
+    MU_ASSERT_TRUE(group.wait(std::chrono::seconds(10)));
+    queue.sync([] {});
+    MU_ASSERT_EQUAL(executed, 1);
+
+    // iterations not started yet are skipped
+    xdispatch::cancellation_source apply_source;
+    executed = 0;
+    queue.apply(
+      kOPERATIONS,
+      [&executed, &apply_source](size_t) {
+          ++executed;
+          apply_source.cancel();
+      },
+      apply_source.token());
+    MU_ASSERT_EQUAL(executed, 1);
+
+    MU_PASS("Cancelled operations were skipped");
+    MU_END_TEST;
+}
@@ -0,0 +1,68 @@
+/*
+ * cxx_deadline.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <thread>
+
+#include "cxx_tests.h"
+
+void
+cxx_deadline(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_deadline);
+
+    const auto queue = cxx_create_queue("cxx_deadline");
+    auto released = std::make_shared<std::atomic<bool>>(false);
+    auto executed = std::make_shared<std::atomic<int>>(0);
+    auto expired = std::make_shared<std::atomic<int>>(0);
+
+    // hold back the queue until the deadlines passed
+    queue.async([released] {
+        while (!*released) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    const auto now = std::chrono::steady_clock::now();
+    queue.async([executed] { ++(*executed); }, now + std::chrono::hours(1));
+    queue.async(xdispatch::make_operation([executed] { *executed += 10; }),
+                now + std::chrono::milliseconds(10),
+                xdispatch::make_operation([expired] { ++(*expired); }));
+    xdispatch::group group(cxx_create_group());
+    group.async(xdispatch::make_operation([executed] { *executed += 100; }),
+                queue,
+                now + std::chrono::milliseconds(10));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    *released = true;
+
+    queue.async([=] {
+        MU_ASSERT_EQUAL(*executed, 1);
+        MU_ASSERT_EQUAL(*expired, 1);
+        MU_ASSERT_EQUAL(queue.expired(), 2);
+        // dropped operations count as completed
+        MU_ASSERT_TRUE(group.wait(std::chrono::milliseconds(0)));
+        MU_PASS("Completed");
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
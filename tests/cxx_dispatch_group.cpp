@@ -23,7 +23,10 @@
 #include <xdispatch/dispatch>
 #include "cxx_tests.h"
 
+#include <atomic>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 /*
  Little tests mainly checking the correct mapping of the c++ api
@@ -105,3 +108,40 @@ cxx_dispatch_group(void* data)
     MU_FAIL("Should never reach this");
     MU_END_TEST
 }
+
+void
+cxx_dispatch_group_generations(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_dispatch_group_generations);
+
+    constexpr int kTHREADS = 4;
+    constexpr int kCYCLES = 20000;
+
+    // the completion of the previous cycle's operation may still be in
+    // progress while the next cycle queues and waits. The wait must not
+    // be satisfied by the previous completion
+    std::atomic<int> early(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kTHREADS; ++t) {
+        threads.emplace_back([&early] {
+            auto group = cxx_create_group();
+            auto queue = cxx_global_queue();
+            std::atomic<int> completed(0);
+            for (int i = 1; i <= kCYCLES; ++i) {
+                group.async([&completed] { ++completed; }, queue);
+                if (!group.wait(std::chrono::seconds(10)) ||
+                    completed != i) {
+                    ++early;
+                    group.wait();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    MU_ASSERT_EQUAL(early, 0);
+    MU_PASS("All waits covered their cycle");
+    MU_END_TEST
+}
@@ -175,12 +175,19 @@ cxx_dispatch_after(const xdispatch::queue& queue)
               MU_PASS("Done");
           });
       });
-    queue.async([&async_complete, &after_complete, counter] {
-        MU_ASSERT_TRUE(!async_complete);
-        MU_ASSERT_TRUE(!after_complete);
-        MU_ASSERT_EQUAL(s_scope_count, 3);
-        async_complete = true;
-    });
+    {
+        // create the operation upfront so that no temporary copy of the
+        // counter is alive anymore in case the operation executes before
+        // async() returned
+        const auto async_op = xdispatch::make_operation(
+          [&async_complete, &after_complete, counter] {
+              MU_ASSERT_TRUE(!async_complete);
+              MU_ASSERT_TRUE(!after_complete);
+              MU_ASSERT_EQUAL(s_scope_count, 3);
+              async_complete = true;
+          });
+        queue.async(async_op);
+    }
     elapsed.start();
 
     cxx_exec();
@@ -0,0 +1,72 @@
+/*
+ * cxx_inline_operation.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <array>
+#include <atomic>
+
+#include <xdispatch/barrier_operation.h>
+
+#include "cxx_tests.h"
+
+void
+cxx_inline_operation(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_inline_operation);
+
+    auto executed = std::make_shared<std::atomic<int>>(0);
+    auto small = [executed] { ++(*executed); };
+    std::array<char, 2 * xdispatch::inline_operation::capacity> payload{};
+    payload.back() = 1;
+    auto large = [executed, payload] { *executed += payload.back(); };
+    MU_ASSERT_TRUE(
+      xdispatch::inline_operation::fits_inline<decltype(small)>::value);
+    MU_ASSERT_TRUE(
+      !xdispatch::inline_operation::fits_inline<decltype(large)>::value);
+
+    // moving keeps the function, releasing converts it to an operation
+    auto op = xdispatch::inline_operation::make(small);
+    auto moved = std::move(op);
+    MU_ASSERT_TRUE(!op);
+    MU_ASSERT_TRUE(static_cast<bool>(moved));
+    const auto released = moved.release();
+    MU_ASSERT_TRUE(!moved);
+    MU_ASSERT_TRUE(nullptr != released);
+    xdispatch::execute_operation_on_this_thread(*released);
+    MU_ASSERT_EQUAL(*executed, 1);
+
+    const auto queue = cxx_create_queue("cxx_inline_operation");
+    queue.async(small);
+    queue.async(large);
+    queue.async(xdispatch::inline_operation::make(large));
+    const auto barrier = std::make_shared<xdispatch::barrier_operation>();
+    queue.async(barrier);
+    MU_ASSERT_TRUE(barrier->wait(std::chrono::seconds(10)));
+    MU_ASSERT_EQUAL(*executed, 4);
+
+    queue.async([=] {
+        MU_ASSERT_EQUAL(*executed, 4);
+        MU_PASS("Completed");
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
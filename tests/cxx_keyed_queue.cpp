@@ -0,0 +1,73 @@
+/*
+ * cxx_keyed_queue.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <xdispatch/keyed_queue.h>
+#include "cxx_tests.h"
+
+constexpr int kKEYS = 64;
+constexpr int kOPS_PER_KEY = 50;
+constexpr size_t kLANES = 8;
+
+struct keyed_state
+{
+    std::vector<int> m_sequences[kKEYS];
+    std::atomic<int> m_remaining{ kKEYS * kOPS_PER_KEY };
+};
+
+void
+cxx_keyed_queue(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_keyed_queue);
+
+    std::vector<xdispatch::queue> lanes;
+    for (size_t i = 0; i < kLANES; ++i) {
+        lanes.push_back(cxx_create_queue("cxx_keyed_queue"));
+    }
+    xdispatch::keyed_queue keyed("cxx_keyed_queue", lanes);
+    MU_ASSERT_EQUAL(keyed.lane_count(), kLANES);
+    MU_ASSERT_TRUE(keyed.lane(7) == keyed.lane(7));
+
+    auto* state = new keyed_state;
+    for (int op = 0; op < kOPS_PER_KEY; ++op) {
+        for (int key = 0; key < kKEYS; ++key) {
+            keyed.async(key, [state, key, op] {
+                state->m_sequences[key].push_back(op);
+                if (0 != --state->m_remaining) {
+                    return;
+                }
+
+                for (const auto& sequence : state->m_sequences) {
+                    MU_ASSERT_EQUAL(sequence.size(), kOPS_PER_KEY);
+                    for (int i = 0; i < kOPS_PER_KEY; ++i) {
+                        MU_ASSERT_EQUAL(sequence[i], i);
+                    }
+                }
+                delete state;
+                MU_PASS("Operations executed in order per key");
+            });
+        }
+    }
+
+    cxx_exec();
+    MU_END_TEST;
+}
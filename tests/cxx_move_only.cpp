@@ -0,0 +1,84 @@
+/*
+ * cxx_move_only.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include "cxx_tests.h"
+
+namespace {
+
+std::atomic<int> s_copies(0);
+
+// counts how often it was copied
+struct copy_counter
+{
+    copy_counter() = default;
+    copy_counter(const copy_counter&) { ++s_copies; }
+    copy_counter(copy_counter&&) noexcept = default;
+};
+
+} // namespace
+
+void
+cxx_move_only(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_move_only);
+
+    const auto queue = cxx_create_queue("cxx_move_only");
+    auto group = cxx_create_group();
+    auto executed = std::make_shared<std::atomic<int>>(0);
+    s_copies = 0;
+
+    // stored inline
+    std::unique_ptr<int> small(new int(1));
+    queue.async([executed, small = std::move(small)] { *executed += *small; });
+
+    // too large to be stored inline
+    std::unique_ptr<int> large(new int(10));
+    std::array<char, 2 * xdispatch::inline_operation::capacity> payload{};
+    group.async(
+      [executed, payload, large = std::move(large)] { *executed += *large; },
+      queue);
+
+    // captures are moved into the operation instead of being copied
+    copy_counter counter;
+    queue.async([executed, counter] { *executed += 100; });
+    auto lambda = [executed, counter] { *executed += 1000; };
+    queue.async(std::move(lambda));
+    auto large_lambda = [executed, counter, payload] { *executed += 10000; };
+    group.async(std::move(large_lambda), queue);
+    MU_ASSERT_EQUAL(s_copies, 3);
+
+    std::unique_ptr<int> iterations(new int(0));
+    queue.apply(3, [counter = std::move(iterations)](size_t) { ++*counter; });
+
+    MU_ASSERT_TRUE(group.wait(std::chrono::seconds(10)));
+    queue.async([=] {
+        MU_ASSERT_EQUAL(*executed, 11111);
+        MU_PASS("Completed");
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
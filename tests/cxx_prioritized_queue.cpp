@@ -0,0 +1,145 @@
+/*
+ * cxx_prioritized_queue.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+#include <xdispatch/prioritized_queue.h>
+#include <xdispatch/impl/iqueue_impl.h>
+#include "cxx_tests.h"
+
+namespace {
+
+class manual_queue_impl : public xdispatch::iqueue_impl
+{
+public:
+    void async(const xdispatch::operation_ptr& op) override
+    {
+        m_ops.push_back(op);
+    }
+    void apply(size_t, const xdispatch::iteration_operation_ptr&) override
+    {
+        MU_FAIL("Not implemented for this test");
+    }
+    void after(std::chrono::milliseconds,
+               const xdispatch::operation_ptr&) override
+    {
+        MU_FAIL("Not implemented for this test");
+    }
+    xdispatch::backend_type backend() override
+    {
+        return static_cast<xdispatch::backend_type>(
+          static_cast<int>(xdispatch::backend_type::naive) + 10);
+    }
+
+    size_t pending() const { return m_ops.size(); }
+
+    void drain_all()
+    {
+        while (!m_ops.empty()) {
+            auto op = m_ops.front();
+            m_ops.pop_front();
+            xdispatch::execute_operation_on_this_thread(*op);
+        }
+    }
+
+private:
+    std::list<xdispatch::operation_ptr> m_ops;
+};
+
+class manual_queue : public xdispatch::queue
+{
+public:
+    manual_queue(const std::string& label)
+      : xdispatch::queue(label, std::make_shared<manual_queue_impl>())
+    {}
+
+    size_t pending() const
+    {
+        const auto inner =
+          std::static_pointer_cast<manual_queue_impl>(implementation());
+        return inner->pending();
+    }
+
+    void drain_all()
+    {
+        const auto inner =
+          std::static_pointer_cast<manual_queue_impl>(implementation());
+        return inner->drain_all();
+    }
+};
+
+} // namespace
+
+void
+cxx_prioritized_queue(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_prioritized_queue);
+
+    // urgent operations overtake waiting ones, equal ones keep their order
+    {
+        manual_queue inner("cxx_prioritized_queue.inner");
+        xdispatch::prioritized_queue prioritized("cxx_prioritized_queue.outer",
+                                                 inner);
+
+        std::vector<int> executed;
+        prioritized.async(1, [&] { executed.push_back(1); });
+        prioritized.async([&] { executed.push_back(0); });
+        prioritized.async(5, [&] { executed.push_back(5); });
+        prioritized.async(3, [&] { executed.push_back(3); });
+        prioritized.async(5, [&] { executed.push_back(6); });
+        prioritized.async(-1, [&] { executed.push_back(-1); });
+        MU_ASSERT_EQUAL(prioritized.depth(), 6);
+        // a single drain is passed to the inner queue for all of them
+        MU_ASSERT_EQUAL(inner.pending(), 1);
+        inner.drain_all();
+        MU_ASSERT_EQUAL(prioritized.depth(), 0);
+
+        const std::vector<int> expected = { 5, 6, 3, 1, 0, -1 };
+        MU_ASSERT_TRUE(expected == executed);
+    }
+
+    // operations are executed mutually exclusive on a real queue
+    xdispatch::prioritized_queue prioritized(
+      "cxx_prioritized_queue", cxx_create_queue("cxx_prioritized_queue"));
+    static constexpr int kRUNS = 1000;
+    auto active = std::make_shared<std::atomic<int>>(0);
+    auto overlapped = std::make_shared<std::atomic<bool>>(false);
+    auto executed = std::make_shared<std::atomic<int>>(0);
+    for (int i = 0; i < kRUNS; ++i) {
+        prioritized.async(i % 7, [active, overlapped, executed] {
+            if (1 != ++(*active)) {
+                *overlapped = true;
+            }
+            --(*active);
+            ++(*executed);
+        });
+    }
+    prioritized.async(-1, [active, overlapped, executed] {
+        MU_ASSERT_TRUE(!*overlapped);
+        MU_ASSERT_EQUAL(*executed, kRUNS);
+        MU_PASS("Completed");
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
@@ -0,0 +1,84 @@
+/*
+ * cxx_queue_specific.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cxx_tests.h"
+
+static int s_key_context = 0;
+static int s_key_other = 0;
+
+void
+cxx_queue_specific(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_queue_specific);
+
+    static int s_context_serial = 1;
+    static int s_context_parallel = 2;
+    static int s_context_replaced = 3;
+
+    const auto serial = cxx_create_queue("cxx_queue_specific");
+    const auto parallel = cxx_global_queue();
+    MU_ASSERT_TRUE(nullptr == serial.get_specific(&s_key_context));
+
+    serial.set_specific(&s_key_context, &s_context_replaced);
+    serial.set_specific(&s_key_other, &s_context_replaced);
+    serial.set_specific(&s_key_other, nullptr);
+    MU_ASSERT_TRUE(nullptr == serial.get_specific(&s_key_other));
+    serial.set_specific(&s_key_context, &s_context_serial);
+    parallel.set_specific(&s_key_context, &s_context_parallel);
+    MU_ASSERT_TRUE(&s_context_serial == serial.get_specific(&s_key_context));
+    MU_ASSERT_TRUE(nullptr == serial.get_specific(&s_key_other));
+    MU_ASSERT_TRUE(!serial.is_current());
+    MU_ASSERT_TRUE(nullptr ==
+                   xdispatch::queue::current_specific(&s_key_context));
+
+#if (defined BUILD_XDISPATCH2_BACKEND_LIBDISPATCH)
+    if (xdispatch::backend_type::libdispatch ==
+        serial.implementation()->backend()) {
+        MU_PASS("Executing queue only reported by naive based backends");
+    }
+#endif
+
+    parallel.async([serial, parallel] {
+        MU_ASSERT_TRUE(parallel.is_current());
+        MU_ASSERT_TRUE(!serial.is_current());
+        MU_ASSERT_TRUE(&s_context_parallel ==
+                       xdispatch::queue::current_specific(&s_key_context));
+
+        serial.async([serial, parallel] {
+            MU_ASSERT_TRUE(serial.is_current());
+            MU_ASSERT_TRUE(!parallel.is_current());
+            MU_ASSERT_TRUE(&s_context_serial ==
+                           xdispatch::queue::current_specific(&s_key_context));
+            MU_ASSERT_TRUE(nullptr ==
+                           xdispatch::queue::current_specific(&s_key_other));
+
+            // the outer queue is restored after a nested sync
+            parallel.async([serial, parallel] {
+                serial.sync([serial] { MU_ASSERT_TRUE(serial.is_current()); });
+                MU_ASSERT_TRUE(parallel.is_current());
+                MU_PASS("Completed");
+            });
+        });
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
@@ -0,0 +1,115 @@
+/*
+ * cxx_ref_ptr.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#include <atomic>
+
+#include <xdispatch/barrier_operation.h>
+
+#include "cxx_tests.h"
+
+namespace {
+
+class counting_operation : public xdispatch::operation
+{
+public:
+    counting_operation(std::atomic<int>& executed, std::atomic<int>& alive)
+      : operation()
+      , m_executed(executed)
+      , m_alive(alive)
+    {
+        ++m_alive;
+    }
+
+    ~counting_operation() override { --m_alive; }
+
+    void operator()() final { ++m_executed; }
+
+private:
+    std::atomic<int>& m_executed;
+    std::atomic<int>& m_alive;
+};
+
+} // namespace
+
+void
+cxx_ref_ptr(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_ref_ptr);
+
+    static std::atomic<int> executed(0);
+    static std::atomic<int> alive(0);
+
+    {
+        auto op = xdispatch::make_ref<counting_operation>(executed, alive);
+        MU_ASSERT_EQUAL(op.use_count(), 1);
+        MU_ASSERT_EQUAL(alive, 1);
+
+        // a shared_ptr holds a reference of its own
+        xdispatch::operation_ptr shared = op;
+        MU_ASSERT_EQUAL(op.use_count(), 2);
+        xdispatch::ref_ptr<xdispatch::operation> base = op;
+        MU_ASSERT_EQUAL(op.use_count(), 3);
+        op.reset();
+        base.reset();
+        MU_ASSERT_EQUAL(alive, 1);
+
+        // converting back references the same object
+        const auto ref = xdispatch::to_ref(shared);
+        MU_ASSERT_TRUE(ref.get() == shared.get());
+        shared.reset();
+        MU_ASSERT_EQUAL(ref.use_count(), 1);
+        xdispatch::execute_operation_on_this_thread(*ref);
+    }
+    MU_ASSERT_EQUAL(alive, 0);
+    MU_ASSERT_EQUAL(executed, 1);
+
+    // operations owned by a shared_ptr only get wrapped
+    const auto shared =
+      std::make_shared<counting_operation>(executed, alive);
+    MU_ASSERT_TRUE(!shared->is_ref_counted());
+    const auto wrapped = xdispatch::to_ref(shared);
+    MU_ASSERT_TRUE(wrapped.get() != shared.get());
+    xdispatch::execute_operation_on_this_thread(*wrapped);
+    MU_ASSERT_EQUAL(executed, 2);
+
+    const auto queue = cxx_create_queue("cxx_ref_ptr");
+    const auto group = cxx_create_group();
+    queue.async(xdispatch::make_ref<counting_operation>(executed, alive));
+    queue.sync(xdispatch::make_ref<counting_operation>(executed, alive));
+    group.async(xdispatch::make_ref<counting_operation>(executed, alive),
+                queue);
+    MU_ASSERT_TRUE(group.wait(std::chrono::seconds(10)));
+    const auto barrier = xdispatch::make_ref<xdispatch::barrier_operation>();
+    queue.async(barrier);
+    MU_ASSERT_TRUE(barrier->wait(std::chrono::seconds(10)));
+    MU_ASSERT_EQUAL(executed, 5);
+
+    queue.async([=] {
+        MU_ASSERT_EQUAL(executed, 5);
+        MU_ASSERT_EQUAL(alive, 1);
+        MU_PASS("Completed");
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
@@ -28,6 +28,8 @@
 void
 cxx_dispatch_group(void*);
 void
+cxx_dispatch_group_generations(void*);
+void
 cxx_dispatch_mainqueue(void*);
 void
 cxx_dispatch_timer_global(void*);
@@ -76,12 +78,52 @@ cxx_benchmark_global_queue(void*);
 void
 cxx_benchmark_group(void*);
 void
+cxx_benchmark_queue_lifecycle(void*);
+void
+cxx_benchmark_lambda_dispatch(void*);
+void
+cxx_benchmark_typed_queue(void*);
+void
+cxx_benchmark_cancelable_scope(void*);
+void
+cxx_benchmark_lightweight_barrier(void*);
+void
+cxx_benchmark_group_wait(void*);
+void
 cxx_waitable_queue(void*);
+void
+cxx_bounded_queue(void*);
+void
+cxx_prioritized_queue(void*);
+void
+cxx_deadline(void*);
+
+void
+cxx_batch_scope(void*);
+
+void
+cxx_inline_operation(void*);
+
+void
+cxx_move_only(void*);
+
+void
+cxx_ref_ptr(void*);
+
+void
+cxx_queue_specific(void*);
+void
+cxx_keyed_queue(void*);
+void
+cxx_typed_queue(void*);
+void
+cxx_cancellation(void*);
 
 void
 register_cxx_tests(const char* name, xdispatch::ibackend* backend)
 {
     MU_REGISTER_TEST_INSTANCE(name, cxx_dispatch_group, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_dispatch_group_generations, backend);
     MU_REGISTER_TEST_INSTANCE(name, cxx_dispatch_mainqueue, backend);
     MU_REGISTER_TEST_INSTANCE(name, cxx_dispatch_timer_main, backend);
     MU_REGISTER_TEST_INSTANCE(name, cxx_dispatch_timer_global, backend);
@@ -106,7 +148,25 @@ register_cxx_tests(const char* name, xdispatch::ibackend* backend)
     MU_REGISTER_TEST_INSTANCE(name, cxx_benchmark_serial_queue, backend);
     MU_REGISTER_TEST_INSTANCE(name, cxx_benchmark_global_queue, backend);
     MU_REGISTER_TEST_INSTANCE(name, cxx_benchmark_group, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_benchmark_queue_lifecycle, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_benchmark_lambda_dispatch, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_benchmark_typed_queue, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_benchmark_cancelable_scope, backend);
+    MU_REGISTER_TEST_INSTANCE(
+      name, cxx_benchmark_lightweight_barrier, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_benchmark_group_wait, backend);
     MU_REGISTER_TEST_INSTANCE(name, cxx_waitable_queue, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_bounded_queue, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_prioritized_queue, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_deadline, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_batch_scope, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_inline_operation, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_move_only, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_ref_ptr, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_queue_specific, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_keyed_queue, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_typed_queue, backend);
+    MU_REGISTER_TEST_INSTANCE(name, cxx_cancellation, backend);
 }
 
 static std::mutex s_backend_CS;
@@ -146,6 +206,9 @@ cxx_global_queue(xdispatch::queue_priority priority)
             case xdispatch::queue_priority::BACKGROUND:
                 q_name = "cxx_global_queue_BACKGROUND";
                 break;
+            case xdispatch::queue_priority::IDLE:
+                q_name = "cxx_global_queue_IDLE";
+                break;
             case xdispatch::queue_priority::DEFAULT:
                 q_name = "cxx_global_queue_DEFAULT";
                 break;
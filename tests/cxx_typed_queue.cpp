@@ -0,0 +1,166 @@
+/*
+ * cxx_typed_queue.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <list>
+#include <stdexcept>
+#include <vector>
+
+#include <xdispatch/typed_queue.h>
+#include "cxx_tests.h"
+
+constexpr int kMESSAGES = 10000;
+
+namespace {
+
+class manual_queue_impl : public xdispatch::iqueue_impl
+{
+public:
+    void async(const xdispatch::operation_ptr& op) override
+    {
+        m_ops.push_back(op);
+    }
+    void apply(size_t, const xdispatch::iteration_operation_ptr&) override
+    {
+        MU_FAIL("Not implemented for this test");
+    }
+    void after(std::chrono::milliseconds,
+               const xdispatch::operation_ptr&) override
+    {
+        MU_FAIL("Not implemented for this test");
+    }
+    xdispatch::backend_type backend() override
+    {
+        return static_cast<xdispatch::backend_type>(
+          static_cast<int>(xdispatch::backend_type::naive) + 10);
+    }
+
+    // @returns the number of operations which threw
+    int drain_all()
+    {
+        int failed = 0;
+        while (!m_ops.empty()) {
+            auto op = m_ops.front();
+            m_ops.pop_front();
+            try {
+                xdispatch::execute_operation_on_this_thread(*op);
+            } catch (const std::runtime_error&) {
+                ++failed;
+            }
+        }
+        return failed;
+    }
+
+private:
+    std::list<xdispatch::operation_ptr> m_ops;
+};
+
+} // namespace
+
+struct typed_state
+{
+    std::atomic<int> m_active{ 0 };
+    int m_next_value{ 0 };
+    int m_next_call{ 0 };
+    std::atomic<int> m_remaining{ 2 };
+
+    void complete()
+    {
+        if (0 == --m_remaining) {
+            delete this;
+            MU_PASS("Messages handled serially and in order");
+        }
+    }
+};
+
+struct typed_message
+{
+    int m_value;
+};
+
+struct typed_call
+{
+    typed_state* m_state;
+    int m_call;
+
+    void operator()() const
+    {
+        MU_ASSERT_EQUAL(m_state->m_next_call, m_call);
+        if (kMESSAGES == ++m_state->m_next_call) {
+            m_state->complete();
+        }
+    }
+};
+
+void
+cxx_typed_queue(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(cxx_typed_queue);
+
+    // a throwing handler does not stop the worker
+    {
+        const auto inner = std::make_shared<manual_queue_impl>();
+        const xdispatch::queue target("cxx_typed_queue.manual", inner);
+        std::vector<int> handled;
+        const auto failing =
+          xdispatch::make_typed_worker<int>(target, [&handled](int&& value) {
+              if (1 == value) {
+                  throw std::runtime_error("cxx_typed_queue");
+              }
+              handled.push_back(value);
+          });
+        for (int i = 0; i < 3; ++i) {
+            failing.async(i);
+        }
+        MU_ASSERT_EQUAL(inner->drain_all(), 1);
+        failing.async(3);
+        MU_ASSERT_EQUAL(inner->drain_all(), 0);
+        MU_ASSERT_EQUAL(handled.size(), 3);
+        MU_ASSERT_EQUAL(handled[0], 0);
+        MU_ASSERT_EQUAL(handled[1], 2);
+        MU_ASSERT_EQUAL(handled[2], 3);
+    }
+
+    auto* state = new typed_state;
+
+    // handlers never overlap, even on a parallel queue
+    const auto worker = xdispatch::make_typed_worker<typed_message>(
+      cxx_global_queue(), [state](typed_message&& msg) {
+          MU_ASSERT_EQUAL(++state->m_active, 1);
+          MU_ASSERT_EQUAL(state->m_next_value, msg.m_value);
+          --state->m_active;
+          if (kMESSAGES == ++state->m_next_value) {
+              state->complete();
+          }
+      });
+    MU_ASSERT_TRUE(worker.target() == cxx_global_queue());
+
+    const xdispatch::typed_serial_queue<typed_call> serial(
+      cxx_create_queue("cxx_typed_queue"));
+
+    for (int i = 0; i < kMESSAGES; ++i) {
+        worker.async(typed_message{ i });
+        serial.emplace(typed_call{ state, i });
+    }
+
+    cxx_exec();
+    MU_END_TEST;
+}
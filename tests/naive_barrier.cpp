@@ -0,0 +1,83 @@
+/*
+ * naive_barrier.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <xdispatch/dispatch>
+#include <xdispatch/backend_naive.h>
+#include "cxx_tests.h"
+
+#include <thread>
+
+constexpr int kREADERS = 20;
+
+struct barrier_state
+{
+    std::atomic<int> m_active{ 0 };
+    std::atomic<int> m_completed{ 0 };
+    std::atomic<bool> m_written{ false };
+};
+
+void
+naive_barrier_async(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(naive_barrier_async);
+
+    auto* state = new barrier_state;
+    // barriers are only honoured by private queues
+    auto queue = xdispatch::naive::create_concurrent_queue(
+      "naive_barrier_async", kREADERS);
+
+    // readers queued before the barrier must have
+    // completed before the barrier executes
+    for (int i = 0; i < kREADERS; ++i) {
+        queue.async([state] {
+            ++state->m_active;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            MU_ASSERT_TRUE(!state->m_written);
+            ++state->m_completed;
+            --state->m_active;
+        });
+    }
+
+    // the barrier must run on its own
+    queue.barrier_async([state] {
+        MU_ASSERT_EQUAL(state->m_active, 0);
+        MU_ASSERT_EQUAL(state->m_completed, kREADERS);
+        ++state->m_active;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        state->m_written = true;
+        --state->m_active;
+    });
+
+    // readers queued after the barrier must see its result
+    for (int i = 0; i < kREADERS; ++i) {
+        queue.async([state] {
+            MU_ASSERT_TRUE(state->m_written);
+            MU_ASSERT_EQUAL(state->m_active, 0);
+            if (2 * kREADERS == ++state->m_completed) {
+                delete state;
+                MU_PASS("Barrier was executed exclusively");
+            }
+        });
+    }
+
+    cxx_exec();
+    MU_END_TEST;
+}
@@ -0,0 +1,125 @@
+/*
+ * naive_boost.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <xdispatch/dispatch>
+#include <xdispatch/backend_naive.h>
+#include "cxx_tests.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// records the priority requested for every operation and holds back
+// all background operations until released, everything else is run
+// on a thread of its own
+class starving_pool : public xdispatch::naive::ithreadpool
+{
+public:
+    void execute(const xdispatch::operation_ptr& work,
+                 xdispatch::queue_priority priority) final
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_CS);
+            m_priorities.push_back(priority);
+            if (xdispatch::queue_priority::BACKGROUND == priority) {
+                m_held.push_back(work);
+                return;
+            }
+        }
+        run(work);
+    }
+
+    std::vector<xdispatch::queue_priority> priorities()
+    {
+        std::lock_guard<std::mutex> lock(m_CS);
+        return m_priorities;
+    }
+
+    void release()
+    {
+        std::vector<xdispatch::operation_ptr> held;
+        {
+            std::lock_guard<std::mutex> lock(m_CS);
+            std::swap(held, m_held);
+        }
+        for (const auto& work : held) {
+            run(work);
+        }
+    }
+
+protected:
+    void notify_thread_blocked() final {}
+    void notify_thread_unblocked() final {}
+
+private:
+    std::mutex m_CS;
+    std::vector<xdispatch::queue_priority> m_priorities;
+    std::vector<xdispatch::operation_ptr> m_held;
+
+    void run(const xdispatch::operation_ptr& work)
+    {
+        std::thread([this, work] { run_with_threadpool(*work, this); })
+          .detach();
+    }
+};
+
+} // namespace
+
+void
+naive_boost_on_wait(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(naive_boost_on_wait);
+
+    const auto pool = std::make_shared<starving_pool>();
+    const auto background = xdispatch::naive::create_serial_queue(
+      "naive_boost_on_wait.background",
+      pool,
+      xdispatch::queue_priority::BACKGROUND);
+    const auto interactive =
+      cxx_create_queue("naive_boost_on_wait.interactive",
+                       xdispatch::queue_priority::USER_INTERACTIVE);
+
+    auto group = cxx_create_group();
+    group.async([] {}, background);
+
+    interactive.async([=] {
+        // the background wakeup is held back by the pool, only a
+        // boosted wakeup will get the operation executed
+        auto waiting = group;
+        MU_ASSERT_TRUE(waiting.wait(std::chrono::seconds(10)));
+
+        const auto recorded = pool->priorities();
+        MU_ASSERT_EQUAL(recorded.size(), 2);
+        MU_ASSERT_TRUE(xdispatch::queue_priority::BACKGROUND == recorded[0]);
+        MU_ASSERT_TRUE(xdispatch::queue_priority::USER_INTERACTIVE ==
+                       recorded[1]);
+
+        // the original wakeup finds the queue drained already
+        pool->release();
+        MU_PASS("Waiting boosted the queue");
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
@@ -0,0 +1,61 @@
+/*
+ * naive_concurrent_queue.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <xdispatch/dispatch>
+#include <xdispatch/backend_naive.h>
+#include "cxx_tests.h"
+
+#include <thread>
+
+constexpr int kJOBS = 40;
+constexpr size_t kWIDTH = 2;
+
+struct width_state
+{
+    std::atomic<size_t> m_active{ 0 };
+    std::atomic<int> m_completed{ 0 };
+};
+
+void
+naive_concurrent_queue_width(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(naive_concurrent_queue_width);
+
+    auto* state = new width_state;
+    auto queue = xdispatch::naive::create_concurrent_queue(
+      "naive_concurrent_queue_width", kWIDTH);
+
+    for (int i = 0; i < kJOBS; ++i) {
+        queue.async([state] {
+            const auto active = ++state->m_active;
+            MU_ASSERT_TRUE(active <= kWIDTH);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            --state->m_active;
+            if (kJOBS == ++state->m_completed) {
+                delete state;
+                MU_PASS("Width was never exceeded");
+            }
+        });
+    }
+
+    cxx_exec();
+    MU_END_TEST;
+}
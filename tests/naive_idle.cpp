@@ -0,0 +1,109 @@
+/*
+ * naive_idle.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <xdispatch/dispatch>
+#include "cxx_tests.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+constexpr int kJOBS = 20;
+
+struct idle_state
+{
+    std::atomic<int> m_started{ 0 };
+
+    std::mutex m_CS;
+    std::condition_variable m_cond;
+    int m_blocked{ 0 };
+    // the number of blocked threads allowed to continue
+    int m_released{ 0 };
+};
+using idle_state_ptr = std::shared_ptr<idle_state>;
+
+static void
+queue_regular_work(const xdispatch::queue& queue, const idle_state_ptr& state)
+{
+    for (int i = 0; i < kJOBS; ++i) {
+        queue.async([state] { ++state->m_started; });
+    }
+}
+
+void
+naive_idle_priority(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(naive_idle_priority);
+
+    const auto state = std::make_shared<idle_state>();
+    const auto regular = cxx_global_queue();
+    const auto idle =
+      cxx_create_queue("naive_idle_priority", xdispatch::queue_priority::IDLE);
+
+    // occupy every thread the pool will spawn, operations queued
+    // afterwards stay pending until the threads are released
+    const int blockers =
+      2 * static_cast<int>(std::thread::hardware_concurrency());
+    for (int i = 0; i < blockers; ++i) {
+        regular.async([state] {
+            std::unique_lock<std::mutex> lock(state->m_CS);
+            ++state->m_blocked;
+            state->m_cond.notify_all();
+            state->m_cond.wait(lock,
+                               [state] { return state->m_released > 0; });
+            --state->m_released;
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(state->m_CS);
+        state->m_cond.wait(
+          lock, [state, blockers] { return state->m_blocked == blockers; });
+    }
+
+    idle.async([regular, state] {
+        // all regular work was preferred, even if queued later
+        MU_ASSERT_EQUAL(state->m_started, kJOBS);
+        queue_regular_work(regular, state);
+    });
+    idle.async([state, blockers] {
+        // the idle queue yielded for the work queued in the meantime
+        MU_ASSERT_EQUAL(state->m_started, 2 * kJOBS);
+        {
+            std::lock_guard<std::mutex> lock(state->m_CS);
+            state->m_released = blockers;
+        }
+        state->m_cond.notify_all();
+        MU_PASS("Idle operations only ran without other work");
+    });
+    queue_regular_work(regular, state);
+
+    // continue with a single thread, so that the order in which it picks
+    // up the pending operations is the order in which they start
+    {
+        std::lock_guard<std::mutex> lock(state->m_CS);
+        state->m_released = 1;
+    }
+    state->m_cond.notify_all();
+
+    cxx_exec();
+    MU_END_TEST;
+}
@@ -0,0 +1,137 @@
+/*
+ * naive_memory_resource.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <xdispatch/dispatch>
+#include <xdispatch/backend_naive.h>
+#include <xdispatch/barrier_operation.h>
+#include "cxx_tests.h"
+
+#include <array>
+#include <thread>
+
+namespace {
+
+// forwards to new_delete_resource() while counting all allocations
+class counting_resource : public xdispatch::memory_resource
+{
+public:
+    std::atomic<size_t> m_allocations{ 0 };
+    std::atomic<size_t> m_outstanding{ 0 };
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) final
+    {
+        ++m_allocations;
+        ++m_outstanding;
+        return xdispatch::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) final
+    {
+        --m_outstanding;
+        xdispatch::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const memory_resource& other) const noexcept final
+    {
+        return this == &other;
+    }
+};
+
+// executes all work directly on the calling thread
+class inline_pool : public xdispatch::naive::ithreadpool
+{
+public:
+    explicit inline_pool(xdispatch::memory_resource* resource)
+      : m_resource(resource)
+    {}
+
+    void execute(const xdispatch::operation_ptr& work,
+                 xdispatch::queue_priority /* priority */) final
+    {
+        run_with_threadpool(*work, this);
+    }
+
+    xdispatch::memory_resource* resource() final { return m_resource; }
+
+protected:
+    void notify_thread_blocked() final {}
+    void notify_thread_unblocked() final {}
+
+private:
+    xdispatch::memory_resource* const m_resource;
+};
+
+} // namespace
+
+void
+naive_memory_resource(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(naive_memory_resource);
+
+    // queues may still be referenced by their last drain request
+    // for a moment after completing all operations
+    static counting_resource s_pool_resource;
+    static counting_resource s_queue_resource;
+
+    {
+        // queues without a resource of their own use the one of the pool
+        const auto pool = std::make_shared<inline_pool>(&s_pool_resource);
+        const auto queue = xdispatch::naive::create_parallel_queue(
+          "naive_memory_resource", pool);
+        MU_ASSERT_TRUE(s_pool_resource.m_allocations > 0);
+
+        int executed = 0;
+        std::array<char, 256> large{};
+        queue.async([&executed] { ++executed; });
+        queue.async([&executed, large] { executed += 1 + large[0]; });
+        queue.apply(4, [&executed](size_t) { ++executed; });
+        auto group = cxx_create_group();
+        group.async([&executed] { ++executed; }, queue);
+        MU_ASSERT_TRUE(group.wait(std::chrono::seconds(10)));
+        MU_ASSERT_EQUAL(executed, 7);
+    }
+    MU_ASSERT_EQUAL(s_pool_resource.m_outstanding.load(), 0);
+
+    {
+        const auto queue = xdispatch::naive::create_concurrent_queue(
+          "naive_memory_resource.concurrent",
+          2,
+          xdispatch::queue_priority::DEFAULT,
+          &s_queue_resource);
+        MU_ASSERT_TRUE(s_queue_resource.m_allocations > 0);
+
+        const auto barrier = std::make_shared<xdispatch::barrier_operation>();
+        std::atomic<int> executed{ 0 };
+        queue.apply(4, [&executed](size_t) { ++executed; });
+        queue.after(std::chrono::milliseconds(1), barrier);
+        MU_ASSERT_TRUE(barrier->wait(std::chrono::seconds(10)));
+        MU_ASSERT_EQUAL(executed.load(), 4);
+    }
+    for (int i = 0; i < 1000 && s_queue_resource.m_outstanding > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    MU_ASSERT_EQUAL(s_queue_resource.m_outstanding.load(), 0);
+
+    MU_PASS("All memory was returned to the resources");
+    MU_END_TEST;
+}
@@ -0,0 +1,102 @@
+/*
+ * naive_priority.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <xdispatch/dispatch>
+#include <xdispatch/backend_naive.h>
+#include "cxx_tests.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// runs every operation on a thread of its own and records
+// the priority requested for it
+class recording_pool : public xdispatch::naive::ithreadpool
+{
+public:
+    void execute(const xdispatch::operation_ptr& work,
+                 xdispatch::queue_priority priority) final
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_CS);
+            m_priorities.push_back(priority);
+        }
+        std::thread([this, work] { run_with_threadpool(*work, this); })
+          .detach();
+    }
+
+    std::vector<xdispatch::queue_priority> priorities()
+    {
+        std::lock_guard<std::mutex> lock(m_CS);
+        return m_priorities;
+    }
+
+protected:
+    void notify_thread_blocked() final {}
+    void notify_thread_unblocked() final {}
+
+private:
+    std::mutex m_CS;
+    std::vector<xdispatch::queue_priority> m_priorities;
+};
+
+} // namespace
+
+void
+naive_priority_propagation(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(naive_priority_propagation);
+
+    const auto pool = std::make_shared<recording_pool>();
+    const auto unspecified = xdispatch::naive::create_serial_queue(
+      "naive_priority_propagation.unspecified", pool);
+    const auto background = xdispatch::naive::create_serial_queue(
+      "naive_priority_propagation.background",
+      pool,
+      xdispatch::queue_priority::BACKGROUND);
+    const auto interactive =
+      cxx_create_queue("naive_priority_propagation.interactive",
+                       xdispatch::queue_priority::USER_INTERACTIVE);
+    MU_ASSERT_TRUE(xdispatch::queue_priority::DEFAULT ==
+                   unspecified.priority());
+    MU_ASSERT_TRUE(xdispatch::queue_priority::USER_INTERACTIVE ==
+                   interactive.priority());
+
+    interactive.async([=] {
+        // only queues without an explicit priority inherit the
+        // priority of the submitting queue
+        background.async([] {});
+        unspecified.async([=] {
+            const auto recorded = pool->priorities();
+            MU_ASSERT_EQUAL(recorded.size(), 2);
+            MU_ASSERT_TRUE(xdispatch::queue_priority::BACKGROUND ==
+                           recorded[0]);
+            MU_ASSERT_TRUE(xdispatch::queue_priority::USER_INTERACTIVE ==
+                           recorded[1]);
+            MU_PASS("Priorities propagated");
+        });
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
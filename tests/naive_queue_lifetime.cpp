@@ -0,0 +1,49 @@
+/*
+ * naive_queue_lifetime.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <xdispatch/dispatch>
+#include "cxx_tests.h"
+
+constexpr int kQUEUES = 10000;
+
+void
+naive_queue_lifetime(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(naive_queue_lifetime);
+
+    // queues released while operations are still pending
+    // must stay alive until all operations were executed
+    auto* completed = new std::atomic<int>(0);
+    for (int i = 0; i < kQUEUES; ++i) {
+        const auto queue = cxx_create_queue("naive_queue_lifetime");
+        for (int j = 0; j < 2; ++j) {
+            queue.async([completed] {
+                if (2 * kQUEUES == ++(*completed)) {
+                    delete completed;
+                    MU_PASS("All operations executed");
+                }
+            });
+        }
+    }
+
+    cxx_exec();
+    MU_END_TEST;
+}
@@ -0,0 +1,63 @@
+/*
+ * naive_sync.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <xdispatch/dispatch>
+#include "cxx_tests.h"
+
+#include <thread>
+
+void
+naive_sync(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(naive_sync);
+
+    const auto queue = cxx_create_queue("naive_sync");
+    const auto caller = std::this_thread::get_id();
+
+    // an idle queue executes on the calling thread
+    std::thread::id executor;
+    queue.sync([&executor] { executor = std::this_thread::get_id(); });
+    MU_ASSERT_TRUE(caller == executor);
+
+    // a busy queue executes all previously queued operations first
+    int counter = 0;
+    queue.async([&counter] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        ++counter;
+    });
+    queue.sync([&counter] { ++counter; });
+    MU_ASSERT_EQUAL(counter, 2);
+
+    // a recursive sync on the same queue does not deadlock
+    queue.sync([&queue, &counter] {
+        queue.sync([&counter] { ++counter; });
+        ++counter;
+    });
+    MU_ASSERT_EQUAL(counter, 4);
+
+    // operations queued during a sync continue on the queue afterwards
+    queue.sync([queue] {
+        queue.async([] { MU_PASS("Queue resumed after sync"); });
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
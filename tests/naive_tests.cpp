@@ -0,0 +1,67 @@
+/*
+ * naive_tests.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "naive_tests.h"
+
+void
+naive_barrier_async(void*);
+
+void
+naive_concurrent_queue_width(void*);
+
+void
+naive_sync(void*);
+
+void
+naive_queue_lifetime(void*);
+
+void
+naive_idle_priority(void*);
+
+void
+naive_priority_propagation(void*);
+
+void
+naive_boost_on_wait(void*);
+
+void
+naive_wait_helping(void*);
+
+void
+naive_wait_helping_serial(void*);
+
+void
+naive_memory_resource(void*);
+
+void
+register_naive_tests(xdispatch::ibackend* backend)
+{
+    MU_REGISTER_TEST_INSTANCE("naive", naive_barrier_async, backend);
+    MU_REGISTER_TEST_INSTANCE("naive", naive_concurrent_queue_width, backend);
+    MU_REGISTER_TEST_INSTANCE("naive", naive_sync, backend);
+    MU_REGISTER_TEST_INSTANCE("naive", naive_queue_lifetime, backend);
+    MU_REGISTER_TEST_INSTANCE("naive", naive_idle_priority, backend);
+    MU_REGISTER_TEST_INSTANCE("naive", naive_priority_propagation, backend);
+    MU_REGISTER_TEST_INSTANCE("naive", naive_boost_on_wait, backend);
+    MU_REGISTER_TEST_INSTANCE("naive", naive_wait_helping, backend);
+    MU_REGISTER_TEST_INSTANCE("naive", naive_wait_helping_serial, backend);
+    MU_REGISTER_TEST_INSTANCE("naive", naive_memory_resource, backend);
+}
@@ -0,0 +1,32 @@
+/*
+ * naive_tests.h
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NAIVE_TESTS_H_
+#define NAIVE_TESTS_H_
+
+#include <xdispatch/impl/ibackend.h>
+
+#include "munit/MUnit.h"
+
+void
+register_naive_tests(xdispatch::ibackend* backend);
+
+#endif /* NAIVE_TESTS_H_ */
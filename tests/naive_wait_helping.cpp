@@ -0,0 +1,200 @@
+/*
+ * naive_wait_helping.cpp
+ *
+ * Copyright (c) 2024 Marius Zwicker
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <xdispatch/dispatch>
+#include <xdispatch/backend_naive.h>
+#include <xdispatch/barrier_operation.h>
+#include "cxx_tests.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// a pool backed by a single thread which never spawns additional
+// threads, i.e. any blocking wait on its thread would deadlock. The
+// thread only refers to the pool while executing work, which keeps
+// the pool alive through the queue it belongs to
+class single_thread_pool : public xdispatch::naive::ithreadpool
+{
+public:
+    single_thread_pool()
+      : m_data(std::make_shared<data>())
+    {
+        const auto data = m_data;
+        std::thread([this, data] {
+            while (true) {
+                const auto work = data->pop(true);
+                run_with_threadpool(*work, this);
+            }
+        }).detach();
+    }
+
+    void execute(const xdispatch::operation_ptr& work,
+                 xdispatch::queue_priority /* priority */) final
+    {
+        m_data->push(work);
+    }
+
+protected:
+    void notify_thread_blocked() final {}
+    void notify_thread_unblocked() final {}
+
+    bool try_execute_pending() final
+    {
+        const auto work = m_data->pop(false);
+        if (!work) {
+            return false;
+        }
+        run_with_threadpool(*work, this);
+        return true;
+    }
+
+private:
+    struct data
+    {
+        std::mutex m_CS;
+        std::condition_variable m_cond;
+        std::deque<xdispatch::operation_ptr> m_work;
+
+        void push(const xdispatch::operation_ptr& work)
+        {
+            std::lock_guard<std::mutex> lock(m_CS);
+            m_work.push_back(work);
+            m_cond.notify_one();
+        }
+
+        xdispatch::operation_ptr pop(bool wait)
+        {
+            std::unique_lock<std::mutex> lock(m_CS);
+            if (wait) {
+                m_cond.wait(lock, [this] { return !m_work.empty(); });
+            } else if (m_work.empty()) {
+                return xdispatch::operation_ptr();
+            }
+            const auto work = m_work.front();
+            m_work.pop_front();
+            return work;
+        }
+    };
+
+    const std::shared_ptr<data> m_data;
+};
+
+} // namespace
+
+void
+naive_wait_helping(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(naive_wait_helping);
+
+    const auto pool = std::make_shared<single_thread_pool>();
+    const auto queue =
+      xdispatch::naive::create_parallel_queue("naive_wait_helping", pool);
+
+    queue.async([=] {
+        // all operations waited for are pending on the very same
+        // thread waiting for them and need to be executed meanwhile
+        auto group = cxx_create_group();
+        int executed = 0;
+        group.async([&executed] { ++executed; }, queue);
+        group.async(
+          [&] {
+              auto nested = cxx_create_group();
+              nested.async([&executed] { ++executed; }, queue);
+              MU_ASSERT_TRUE(nested.wait(std::chrono::seconds(10)));
+          },
+          queue);
+        MU_ASSERT_TRUE(group.wait(std::chrono::seconds(10)));
+        MU_ASSERT_EQUAL(executed, 2);
+
+        const auto barrier = std::make_shared<xdispatch::barrier_operation>();
+        queue.async(barrier);
+        MU_ASSERT_TRUE(barrier->wait(std::chrono::seconds(10)));
+
+        queue.apply(3, [&executed](size_t) { ++executed; });
+        MU_ASSERT_EQUAL(executed, 5);
+        MU_PASS("Waits made progress");
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
+
+void
+naive_wait_helping_serial(void* data)
+{
+    CXX_BEGIN_BACKEND_TEST(naive_wait_helping_serial);
+
+    constexpr int kSYNCS = 32;
+
+    struct state
+    {
+        std::atomic<bool> m_inside{ false };
+        std::atomic<int> m_overlaps{ 0 };
+        std::atomic<int> m_synced{ 0 };
+    };
+    const auto s = std::make_shared<state>();
+    const auto serial = cxx_create_queue("naive_wait_helping_serial");
+    const auto global = cxx_global_queue();
+    auto syncs = cxx_create_group();
+
+    serial.async([=] {
+        s->m_inside = true;
+        // operations pending on the pool while the serial queue waits
+        // must not be executed as part of the waiting operation, or
+        // their sync() would bypass the serial queue's exclusion
+        for (int i = 0; i < kSYNCS; ++i) {
+            syncs.async(
+              [=] {
+                  serial.sync([=] {
+                      if (s->m_inside) {
+                          ++s->m_overlaps;
+                      }
+                      ++s->m_synced;
+                  });
+              },
+              global);
+        }
+
+        auto group = cxx_create_group();
+        group.async(
+          [] { std::this_thread::sleep_for(std::chrono::milliseconds(100)); },
+          global);
+        MU_ASSERT_TRUE(group.wait(std::chrono::seconds(10)));
+        s->m_inside = false;
+
+        syncs.notify(
+          [=] {
+              MU_ASSERT_EQUAL(s->m_synced, kSYNCS);
+              MU_ASSERT_EQUAL(s->m_overlaps, 0);
+              MU_PASS("Serial queue stayed exclusive");
+          },
+          global);
+    });
+
+    cxx_exec();
+    MU_END_TEST;
+}
@@ -56,3 +56,17 @@ ${TESTS} -n libdispatch__cxx_benchmark_group
 ${TESTS} -n naive__cxx_benchmark_group
 ${TESTS} -n qt5__cxx_benchmark_group
 echo ""
+
+echo "BENCHMARK QUEUE LIFECYCLE"
+echo "========================="
+${TESTS} -n libdispatch__cxx_benchmark_queue_lifecycle
+${TESTS} -n naive__cxx_benchmark_queue_lifecycle
+${TESTS} -n qt5__cxx_benchmark_queue_lifecycle
+echo ""
+
+echo "BENCHMARK LAMBDA DISPATCH"
+echo "========================="
+${TESTS} -n libdispatch__cxx_benchmark_lambda_dispatch
+${TESTS} -n naive__cxx_benchmark_lambda_dispatch
+${TESTS} -n qt5__cxx_benchmark_lambda_dispatch
+echo ""